@@ -2,11 +2,81 @@
 
 #include <iostream>
 #include <vector>
+#include <span>
+#include <cstddef>
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <algorithm>
 #include <climits>
 #include <compare>
+#include <concepts>
+#include <type_traits>
 #include <iomanip>
+#include <tuple>
+#include <stdexcept>
+
+#include "LimbVector.h"
+
+// Машинные целые до 64 бит для операций с лимбом (bool не считается)
+template <typename T>
+concept LimbScalar = std::integral<T> && !std::same_as<T, bool> && sizeof(T) <= 8;
+
+class MontgomeryContext;
+
+/** class BigIntegerView
+ *  read-only view of a number in someone else's memory
+ *
+ *  Указатель на лимбы (младший первый), их число и знак - и больше ничего, память
+ *  не копируется и виду не принадлежит. BigInteger приводится к нему неявно,
+ *  сравнения и арифметика принимают виды, так что куски чисел и чужие буферы
+ *  (mmap, сетевые кадры) идут в дело без копирования в limbs_.
+ *  Старшие нулевые лимбы отбрасываются при создании, у нуля длина 0.
+ */
+class BigIntegerView {
+public:
+    using limb_t = u_int64_t;
+
+    constexpr BigIntegerView() noexcept = default;
+    constexpr BigIntegerView(const limb_t* limbs, size_t size, bool negative = false) noexcept
+        : limbs_(limbs), size_(size) {
+        while (size_ && limbs_[size_ - 1] == 0)
+            --size_;
+        negative_ = negative && size_;
+    }
+    constexpr BigIntegerView(std::span<const limb_t> limbs, bool negative = false) noexcept
+        : BigIntegerView(limbs.data(), limbs.size(), negative) {}
+
+    constexpr const limb_t* data() const noexcept { return limbs_; }
+    constexpr size_t size() const noexcept { return size_; }
+    constexpr bool isNegative() const noexcept { return negative_; }
+    constexpr bool isZero() const noexcept { return size_ == 0; }
+    constexpr std::span<const limb_t> limbs() const noexcept { return {limbs_, size_}; }
+
+    constexpr BigIntegerView abs() const noexcept { return {limbs_, size_}; }
+    // Лимбы модуля [from, from + count) как неотрицательное число, лишнее обрезается
+    constexpr BigIntegerView slice(size_t from, size_t count) const noexcept {
+        from = std::min(from, size_);
+        return {limbs_ + from, std::min(count, size_ - from)};
+    }
+
+    friend constexpr std::strong_ordering operator<=>(BigIntegerView a, BigIntegerView b) noexcept {
+        if (a.negative_ != b.negative_)
+            return a.negative_ ? std::strong_ordering::less : std::strong_ordering::greater;
+        std::strong_ordering abs = a.size_ <=> b.size_;
+        for (size_t i = a.size_; abs == 0 && i-- > 0;)
+            abs = a.limbs_[i] <=> b.limbs_[i];
+        return a.negative_ ? 0 <=> abs : abs;
+    }
+    friend constexpr bool operator==(BigIntegerView a, BigIntegerView b) noexcept {
+        return a.negative_ == b.negative_ && std::ranges::equal(a.limbs(), b.limbs());
+    }
+
+private:
+    const limb_t* limbs_ = nullptr;
+    size_t size_ = 0;
+    bool negative_ = false;
+};
 
 /** class BigInteger
  *  class for operations on big integers
@@ -15,131 +85,401 @@ class BigInteger {
 public:
     using bi_limb_t = u_int64_t;    // Один лимб - 64 битное беззнаковое целое
 private:
-    std::vector<bi_limb_t> limbs_;  // массив лимбов
+    friend class MontgomeryContext;     // работает прямо на лимбах и ядрах умножения
+
+    LimbVector limbs_;              // массив лимбов, короткие числа без кучи
     bool negative_;                 // знак числа (false = positive)
 
     void normalize();
-    static int cmpAbs(const BigInteger& a, const BigInteger& b);
+    void assignView(BigIntegerView v);
+    static int cmpAbs(BigIntegerView a, BigIntegerView b);
 
     inline bool isZero() const { return limbs_.size() == 1 && limbs_[0] == 0; }
 
     // Вспомогательные функции для арифметики
-    static BigInteger addAbs(const BigInteger& a, const BigInteger& b);
-    static BigInteger subAbs(const BigInteger& a, const BigInteger& b);
+    static void addAbsInPlace(BigInteger& r, BigIntegerView b);     // |r| += |b|
+    static void subAbsInPlace(BigInteger& r, BigIntegerView b);     // |r| -= |b|, |r| >= |b|
+    static void subAbsReversed(BigInteger& r, BigIntegerView b);    // |r| = |b| - |r|, |b| >= |r|
 
-    using MulFunc = BigInteger(*)(const BigInteger&, const BigInteger&);
+    // Пороги переключения алгоритмов умножения (в лимбах, по меньшему множителю)
+    static constexpr size_t KARATSUBA_THRESHOLD = 32;
+    static constexpr size_t KARATSUBA_SQR_THRESHOLD = 48;  // для квадратов школьный дешевле
+    static constexpr size_t TOOM3_THRESHOLD = 150;
+    static constexpr size_t TOOM4_THRESHOLD = 400;
+    static constexpr size_t NTT_THRESHOLD = 4096;
+    static constexpr size_t PARALLEL_THRESHOLD = 1024;  // с него подпроизведения идут задачами
 
-    static BigInteger schoolMul(const BigInteger& a, const BigInteger& b);
-    static BigInteger karatsubaMul(const BigInteger& a, const BigInteger& b);
-    static std::pair<BigInteger, BigInteger> divMod(const BigInteger& a, const BigInteger& b);
+    static bi_limb_t divLimb(BigInteger& x, bi_limb_t d);   // |x| /= d, возвращает остаток
+
+    // Операции с одним лимбом: v - модуль скаляра, negative - его знак
+    template <LimbScalar T>
+    static bi_limb_t absLimb(T v) {
+        if constexpr (std::is_signed_v<T>)
+            return v < 0 ? 0 - static_cast<bi_limb_t>(v) : static_cast<bi_limb_t>(v);
+        else
+            return v;
+    }
+    template <LimbScalar T>
+    static bool negativeScalar(T v) {
+        if constexpr (std::is_signed_v<T>)
+            return v < 0;
+        else
+            return false;
+    }
+    void addSmall(bi_limb_t v, bool negative);
+    void mulSmall(bi_limb_t v, bool negative);
+    void divSmall(bi_limb_t v, bool negative);
+    void modSmall(bi_limb_t v);          // знак остатка как у делимого
+
+    // r = r op b для op из '&', '|', '^' в дополнительном коде (Bits.cpp)
+    static void bitwise(BigInteger& r, const BigInteger& b, char op);
+
+    // Умножение модулей на массивах лимбов: rp[0, an + bn) = a * b, rp не пересекается
+    // с аргументами. Временная память рекурсии берётся из арены потока (Scratch.h)
+    static BigInteger mulAlgo(BigIntegerView a, BigIntegerView b);
+    void addProduct(const BigInteger& a, const BigInteger& b, bool subtract);  // *this -+= a * b
+    static BigInteger fusedProduct(const BigInteger& c, const BigInteger& a, const BigInteger& b,
+                                   bool subtract);                       // c -+ a * b
+    static BigInteger mulRem(const BigInteger& a, const BigInteger& b, const BigInteger& m);
+    static size_t mulScratchSize(size_t an, size_t bn);
+    static void mulLimbs(bi_limb_t* rp, const bi_limb_t* ap, size_t an,
+                         const bi_limb_t* bp, size_t bn);     // выбор алгоритма
+    static void schoolMul(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn);
+    static void schoolSqr(bi_limb_t* rp, const bi_limb_t* ap, size_t n);
+    static void karatsubaMul(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn);
+    static void toom3Mul(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn);
+    static void toom4Mul(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn);
+    static void unbalancedMul(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn);
+    static void nttMul(bi_limb_t* rp, const bi_limb_t* ap, size_t an,
+                       const bi_limb_t* bp, size_t bn);       // NTT.cpp
+
+    // Деление: порог перехода от алгоритма Кнута к рекурсивному делению.
+    // Ядра работают на месте: делимое в up/ap, остаток остаётся в его младших лимбах
+    static constexpr size_t BZ_THRESHOLD = 80;
+
+    static void divKnuth(bi_limb_t* qp, bi_limb_t* up, size_t un, const bi_limb_t* vp, size_t n);
+    static void div2n1n(bi_limb_t* qp, bi_limb_t* ap, const bi_limb_t* bp, size_t n);
+    static void div3n2n(bi_limb_t* qp, bi_limb_t* ap, const bi_limb_t* bp, size_t h);
+    static std::pair<BigInteger, BigInteger> divSchool(BigIntegerView a, BigIntegerView b);
+    static std::pair<BigInteger, BigInteger> divBurnikelZiegler(BigIntegerView a, BigIntegerView b);
+    static std::pair<BigInteger, BigInteger> divMod(BigIntegerView a, BigIntegerView b);
+
+    // НОД (GCD.cpp): шаги Лемера по старшим 128 битам, для длинных чисел -
+    // рекурсивный half-GCD. Матрица M связывает пары: (a, b) = M (a', b')
+    static constexpr size_t HGCD_THRESHOLD = 150;      // в лимбах
+    struct GcdMatrix;
+
+    static bool gcdStep(BigInteger& a, BigInteger& b, size_t s, GcdMatrix* m);
+    static bool hgcd(BigInteger& a, BigInteger& b, GcdMatrix& m);
+    static bool hgcdReduce(BigInteger& a, BigInteger& b, size_t p, GcdMatrix* m);
+    static void splitBits(const BigInteger& x, size_t p, BigInteger& high, BigInteger& low);
+
+    // Перевод из строк (Radix.cpp): до порога - схема Горнера, дальше делим пополам
+    static constexpr size_t RADIX_THRESHOLD = 40;
+
+    static const BigInteger& radixPower(unsigned base, size_t k);   // (base^digits)^(2^k)
+    static BigInteger fromChunks(const bi_limb_t* chunks, size_t count, unsigned base);
+    static BigInteger fromDigits(std::string_view digits);
+
+    // Перевод в строки: большие цифры числа и их запись символами
+    static void toChunks(const BigInteger& x, unsigned base, bi_limb_t* out, size_t count);
+    std::vector<bi_limb_t> toChunks(unsigned base) const;
+    static size_t formatChunks(const std::vector<bi_limb_t>& chunks, unsigned base,
+                               bool uppercase, char* out);
+
+    // Проверки простоты (Prime.cpp) прямо в форме Монтгомери по нечётному модулю
+    static bool millerRabin(const MontgomeryContext& ctx, const BigInteger& base);
+    static bool strongLucas(const MontgomeryContext& ctx);
 
 public:
     // Конструкторы
-    BigInteger() : limbs_(0), negative_(false) {}
+    BigInteger() : limbs_(1, 0), negative_(false) {}
 
     BigInteger(long long value)
-        : negative_(value < 0)
-        , limbs_{static_cast<bi_limb_t>(value < 0 ? -value : value)}{}
+        : limbs_(1, value < 0 ? 0 - static_cast<bi_limb_t>(value) : static_cast<bi_limb_t>(value))
+        , negative_(value < 0) {}
 
-    BigInteger(const std::string& str);
+    // Десятичная строка с необязательным минусом, иначе std::runtime_error
+    BigInteger(std::string_view str);
+    BigInteger(const std::string& str) : BigInteger(std::string_view(str)) {}
+    // Шаблон, чтобы BigInteger(0) не спорил с указателем
+    template <std::same_as<char> C>
+    BigInteger(const C* str) : BigInteger(std::string_view(str)) {}
     BigInteger(const BigInteger&) = default;
     BigInteger(BigInteger&&) noexcept = default;
     BigInteger& operator=(const BigInteger&) = default;
     BigInteger& operator=(BigInteger&&) noexcept = default;
 
+    // Копия числа из вида (в обратную сторону приведение неявное и бесплатное)
+    explicit BigInteger(BigIntegerView v) : negative_(false) { assignView(v); }
+    operator BigIntegerView() const noexcept {
+        return {limbs_.data(), isZero() ? 0 : limbs_.size(), negative_};
+    }
+
+    // Ленивое произведение по явной просьбе: BigInteger::lazy(a) * b. Узел хранит
+    // только ссылки на множители и считается при присваивании сразу в буфер
+    // приёмника, а в x = lazy(a) * b, c + lazy(a) * b, c - lazy(a) * b,
+    // x += lazy(a) * b, lazy(a) * b + lazy(d) * e, (lazy(a) * b) % m идёт в
+    // совмещённые ядра (addmul/submul, остаток без частного) без промежуточного
+    // BigInteger под произведение. Обычный a * b сразу даёт BigInteger: с ленивым
+    // узлом ломались auto p = a * b (ссылки на умершие множители) и (a * b).pow(2).
+    // Висячих ссылок не даёт сам API: временные в множители не берутся, а узел
+    // принимается только как rvalue, так что auto p = lazy(a) * b дальше никуда
+    // не подставить (кроме явного std::move(p) - тогда a и b должны быть живы)
+    class LazyFactor;
+    class MulExpr {
+    public:
+        MulExpr(const MulExpr&) = delete;
+        MulExpr& operator=(const MulExpr&) = delete;
+        operator BigInteger() && { return mulAlgo(a_, b_); }
+
+        const BigInteger& a_;
+        const BigInteger& b_;
+
+    private:
+        friend class LazyFactor;
+        MulExpr(const BigInteger& a, const BigInteger& b) : a_(a), b_(b) {}
+    };
+
+    // Левый множитель ленивого произведения
+    class LazyFactor {
+    public:
+        MulExpr operator*(const BigInteger& b) const { return MulExpr(x_, b); }
+        MulExpr operator*(const BigInteger&&) const = delete;
+
+    private:
+        friend class BigInteger;
+        explicit LazyFactor(const BigInteger& x) : x_(x) {}
+
+        const BigInteger& x_;
+    };
+
+    static LazyFactor lazy(const BigInteger& x) { return LazyFactor(x); }
+    static LazyFactor lazy(const BigInteger&&) = delete;
+
+    BigInteger& operator=(MulExpr&& product);
+    BigInteger& operator+=(MulExpr&& product) { addProduct(product.a_, product.b_, false); return *this; }
+    BigInteger& operator-=(MulExpr&& product) { addProduct(product.a_, product.b_, true); return *this; }
+
     // Операции с присваиванием, через них потом френдов реализуем
     // типо чтобы было меньше копирований, в реализациях этих операций 
     // всё делаем по честному через лимбы, а потом юзаем их во френдах
-    BigInteger& operator+=(const BigInteger& other);
-    BigInteger& operator-=(const BigInteger& other);
-    BigInteger& operator*=(const BigInteger& other);
-    BigInteger& operator/=(const BigInteger& other);
-    BigInteger& operator%=(const BigInteger& other);
+    BigInteger& operator+=(BigIntegerView other);
+    BigInteger& operator-=(BigIntegerView other);
+    BigInteger& operator*=(BigIntegerView other);
+    BigInteger& operator/=(BigIntegerView other);
+    BigInteger& operator%=(BigIntegerView other);
+    BigInteger& operator+=(const BigInteger& other) { return *this += BigIntegerView(other); }
+    BigInteger& operator-=(const BigInteger& other) { return *this -= BigIntegerView(other); }
+    BigInteger& operator*=(const BigInteger& other) { return *this *= BigIntegerView(other); }
+    BigInteger& operator/=(const BigInteger& other) { return *this /= BigIntegerView(other); }
+    BigInteger& operator%=(const BigInteger& other) { return *this %= BigIntegerView(other); }
 
     // друзья арифметические операции над большими числами
     friend BigInteger operator+(const BigInteger& a, const BigInteger& b);
     friend BigInteger operator-(const BigInteger& a, const BigInteger& b);
     friend BigInteger operator/(const BigInteger& a, const BigInteger& b);
     friend BigInteger operator%(const BigInteger& a, const BigInteger& b);
-    friend BigInteger operator*(const BigInteger& a, const BigInteger& b);
+    friend BigInteger operator*(const BigInteger& a, const BigInteger& b) { return mulAlgo(a, b); }
 
-    // Функция для возведения в степень (для небольших степеней)
-    BigInteger pow(unsigned long long exp) const;
+    // перегрузки для временных: переиспользуют их буфер лимбов
+    friend BigInteger operator+(BigInteger&& a, const BigInteger& b);
+    friend BigInteger operator+(const BigInteger& a, BigInteger&& b);
+    friend BigInteger operator+(BigInteger&& a, BigInteger&& b);
+    friend BigInteger operator-(BigInteger&& a, const BigInteger& b);
+    friend BigInteger operator-(const BigInteger& a, BigInteger&& b);
+    friend BigInteger operator-(BigInteger&& a, BigInteger&& b);
+    friend BigInteger operator*(BigInteger&& a, const BigInteger& b);
+    friend BigInteger operator*(const BigInteger& a, BigInteger&& b);
+    friend BigInteger operator*(BigInteger&& a, BigInteger&& b);
+    friend BigInteger operator/(BigInteger&& a, const BigInteger& b);
+    friend BigInteger operator%(BigInteger&& a, const BigInteger& b);
 
-    // Функции для доступа к приватным членам
-    const auto& get_limbs() const {
-        return limbs_;
-    }
+    // С видами: когда хоть один операнд - BigIntegerView, он читается прямо
+    // из своей памяти (объявлены и снаружи класса, чтобы находились для двух видов)
+    friend BigInteger operator+(BigIntegerView a, BigIntegerView b);
+    friend BigInteger operator-(BigIntegerView a, BigIntegerView b);
+    friend BigInteger operator*(BigIntegerView a, BigIntegerView b);
+    friend BigInteger operator/(BigIntegerView a, BigIntegerView b);
+    friend BigInteger operator%(BigIntegerView a, BigIntegerView b);
 
-    // Далее определяем сравнение больших чисел через спейсшип
-    std::strong_ordering operator<=>(const BigInteger& other) const {
-        // Сначала учитываем знак
-        if (negative_ != other.negative_) {
-            return negative_ ? std::strong_ordering::less
-                             : std::strong_ordering::greater;
-        }
-
-        // Если разное количество лимбов
-        if (limbs_.size() != other.limbs_.size()) {
-            if (limbs_.size() < other.limbs_.size())
-                return negative_ ? std::strong_ordering::greater
-                                 : std::strong_ordering::less;
-            else
-                return negative_ ? std::strong_ordering::less
-                                 : std::strong_ordering::greater;
-        }
-
-        // Сравниваем по лимбам начиная с самых старших
-        for (size_t i = limbs_.size(); i-- > 0;) {
-            if (limbs_[i] < other.limbs_[i])
-                return negative_ ? std::strong_ordering::greater
-                                 : std::strong_ordering::less;
-            else if (limbs_[i] > other.limbs_[i])
-                return negative_ ? std::strong_ordering::less
-                                 : std::strong_ordering::greater;
-        }
-
-        // Все лимбы равны
-        return std::strong_ordering::equal;
+    // Совмещённые операции с ленивым произведением
+    friend BigInteger operator+(const BigInteger& c, MulExpr&& p) { return fusedProduct(c, p.a_, p.b_, false); }
+    friend BigInteger operator+(BigInteger&& c, MulExpr&& p) { return std::move(c += std::move(p)); }
+    friend BigInteger operator+(MulExpr&& p, const BigInteger& c) { return fusedProduct(c, p.a_, p.b_, false); }
+    friend BigInteger operator+(MulExpr&& p, BigInteger&& c) { return std::move(c += std::move(p)); }
+    friend BigInteger operator-(const BigInteger& c, MulExpr&& p) { return fusedProduct(c, p.a_, p.b_, true); }
+    friend BigInteger operator-(BigInteger&& c, MulExpr&& p) { return std::move(c -= std::move(p)); }
+    friend BigInteger operator-(MulExpr&& p, BigInteger c) {
+        c -= std::move(p);              // p - c = -(c - p)
+        c.negative_ = !c.negative_;
+        c.normalize();
+        return c;
     }
+    friend BigInteger operator+(MulExpr&& p, MulExpr&& q) { BigInteger r = std::move(p); return std::move(r += std::move(q)); }
+    friend BigInteger operator-(MulExpr&& p, MulExpr&& q) { BigInteger r = std::move(p); return std::move(r -= std::move(q)); }
+    friend BigInteger operator%(MulExpr&& p, const BigInteger& m) { return mulRem(p.a_, p.b_, m); }
 
-    bool operator==(const BigInteger& other) const {
-        if (negative_ != other.negative_) return false;
-        if (limbs_.size() != other.limbs_.size()) return false;
-        for (size_t i = 0; i < limbs_.size(); ++i) {
-            if (limbs_[i] != other.limbs_[i]) return false;
-        }
-        return true;
+    // Со скалярами (int, uint64_t, ...) без временного BigInteger:
+    // ядра на один лимб, деление через заранее посчитанный обратный
+    template <LimbScalar T>
+    BigInteger& operator+=(T v) { addSmall(absLimb(v), negativeScalar(v)); return *this; }
+    template <LimbScalar T>
+    BigInteger& operator-=(T v) { addSmall(absLimb(v), v > 0); return *this; }
+    template <LimbScalar T>
+    BigInteger& operator*=(T v) { mulSmall(absLimb(v), negativeScalar(v)); return *this; }
+    template <LimbScalar T>
+    BigInteger& operator/=(T v) { divSmall(absLimb(v), negativeScalar(v)); return *this; }
+    template <LimbScalar T>
+    BigInteger& operator%=(T v) { modSmall(absLimb(v)); return *this; }
+
+    // Большое число берём по значению: временное переиспользуется, lvalue копируется
+    template <LimbScalar T>
+    friend BigInteger operator+(BigInteger a, T b) { return std::move(a += b); }
+    template <LimbScalar T>
+    friend BigInteger operator+(T a, BigInteger b) { return std::move(b += a); }
+    template <LimbScalar T>
+    friend BigInteger operator-(BigInteger a, T b) { return std::move(a -= b); }
+    template <LimbScalar T>
+    friend BigInteger operator-(T a, BigInteger b) {
+        b.negative_ = !b.negative_;     // a - b = -b + a
+        b.normalize();
+        return std::move(b += a);
     }
+    template <LimbScalar T>
+    friend BigInteger operator*(BigInteger a, T b) { return std::move(a *= b); }
+    template <LimbScalar T>
+    friend BigInteger operator*(T a, BigInteger b) { return std::move(b *= a); }
+    template <LimbScalar T>
+    friend BigInteger operator/(BigInteger a, T b) { return std::move(a /= b); }
+    template <LimbScalar T>
+    friend BigInteger operator%(BigInteger a, T b) { return std::move(a %= b); }
+    // Иначе со скаляром неоднозначно: и MulExpr, и скаляр приводятся к BigInteger
+    template <LimbScalar T>
+    friend BigInteger operator+(MulExpr&& p, T b) { return BigInteger(std::move(p)) + b; }
+    template <LimbScalar T>
+    friend BigInteger operator+(T a, MulExpr&& p) { return BigInteger(std::move(p)) + a; }
+    template <LimbScalar T>
+    friend BigInteger operator-(MulExpr&& p, T b) { return BigInteger(std::move(p)) - b; }
+    template <LimbScalar T>
+    friend BigInteger operator-(T a, MulExpr&& p) { return a - BigInteger(std::move(p)); }
+    template <LimbScalar T>
+    friend BigInteger operator%(MulExpr&& p, T b) { return BigInteger(std::move(p)) % b; }
 
-    // Расширенный алгоритм Евклида для вычисления НОДа и коэффициентов безу
-    static std::tuple<BigInteger, BigInteger, BigInteger> extendedGCD(BigInteger a, BigInteger b) {
-        BigInteger x0(1), y0(0);
-        BigInteger x1(0), y1(1);
+    // Сдвиги и побитовые операции (Bits.cpp). Отрицательные числа ведут себя как
+    // в дополнительном коде с бесконечным знаковым битом, как в GMP:
+    // x >> k - деление на 2^k с округлением вниз, ~x = -x - 1
+    BigInteger& operator<<=(size_t bits);
+    BigInteger& operator>>=(size_t bits);
+    BigInteger& operator&=(const BigInteger& other) { bitwise(*this, other, '&'); return *this; }
+    BigInteger& operator|=(const BigInteger& other) { bitwise(*this, other, '|'); return *this; }
+    BigInteger& operator^=(const BigInteger& other) { bitwise(*this, other, '^'); return *this; }
+    BigInteger operator~() const;
 
-        while (!b.isZero()) {
-            BigInteger q = a / b;
-            BigInteger r = a % b;
+    friend BigInteger operator<<(BigInteger a, size_t bits) { return std::move(a <<= bits); }
+    friend BigInteger operator>>(BigInteger a, size_t bits) { return std::move(a >>= bits); }
+    friend BigInteger operator&(BigInteger a, const BigInteger& b) { return std::move(a &= b); }
+    friend BigInteger operator|(BigInteger a, const BigInteger& b) { return std::move(a |= b); }
+    friend BigInteger operator^(BigInteger a, const BigInteger& b) { return std::move(a ^= b); }
 
-            BigInteger x2 = x0 - q * x1;
-            BigInteger y2 = y0 - q * y1;
+    size_t bitLength() const;               // длина модуля в битах, у нуля 0
+    size_t popcount() const;                // единицы; у отрицательных их бесконечно - SIZE_MAX
+    size_t trailingZeros() const;           // нули снизу (у -x столько же), у нуля 0
+    bool testBit(size_t bit) const;
+    void setBit(size_t bit, bool value = true);
 
-            a = std::move(b);
-            b = std::move(r);
-            x0 = std::move(x1);
-            y0 = std::move(y1);
-            x1 = std::move(x2);
-            y1 = std::move(y2);
-        }
+    // Запись числа в системе счисления base (2..36), цифры больше 9 - строчные буквы
+    std::string toString(int base = 10) const;
 
-        return {a, x0, y0}; // a — gcd, x0 и y0 — коэффициенты Безу
+    // Параллельный режим для умножения больших чисел, по умолчанию выключен.
+    // threads - сколько потоков использовать (0 - по числу ядер, 1 - выключить).
+    // Результат не зависит от числа потоков. Менять, пока идут вычисления, нельзя
+    static void setThreadCount(unsigned threads);
+    static unsigned threadCount();
+
+    // Возведение в степень окном слева направо, основание 2^k - сдвигом
+    BigInteger pow(unsigned long long exp) const;
+
+    // this^exp mod m, результат в [0, m). Для многих вычислений по одному
+    // модулю выгоднее один раз построить MontgomeryContext (Montgomery.cpp)
+    BigInteger modPow(const BigInteger& exp, const BigInteger& mod) const;
+
+    // Корни методом Ньютона с удвоением точности (Root.cpp): целая часть корня
+    // за константу умножений и делений полной длины. Корень чётной степени из
+    // отрицательного и k = 0 - std::invalid_argument, корень нечётной степени из
+    // отрицательного округляется к нулю (как mpz_root)
+    BigInteger isqrt() const;
+    std::pair<BigInteger, BigInteger> sqrtRem() const;     // {s, r}: s^2 + r = this, 0 <= r <= 2s
+    BigInteger nthRoot(unsigned long long k) const;
+
+    // Равно ли a^k при каком-то k >= 2. Как mpz_perfect_power_p: 0, 1 и -1 - да,
+    // отрицательные - только нечётные степени
+    bool isPerfectPower() const;
+
+    // Вероятностная проверка на простоту (Prime.cpp): пробное деление на простые
+    // до 1000, затем BPSW - Миллер-Рабин по основанию 2 и сильный тест Люка.
+    // До 2^64 ответ точный, контрпримеров к BPSW не известно. rounds - сколько
+    // ещё раундов Миллера-Рабина по псевдослучайным основаниям (зависят только от
+    // числа, ответ воспроизводим). Числа меньше 2 не простые
+    bool isProbablePrime(unsigned rounds = 0) const;
+
+    // Тест Люка-Лемера: простое ли 2^p - 1. Квадрат берётся самым быстрым
+    // умножением для этой длины, остаток по модулю 2^p - 1 - сложением старшей
+    // и младшей половин, без деления. Время - p квадратов по p бит
+    static bool lucasLehmer(unsigned long long p);
+
+    // Функции для доступа к приватным членам (лимбы от младшего к старшему)
+    std::span<const bi_limb_t> get_limbs() const {
+        return {limbs_.data(), limbs_.size()};
     }
 
-    // НОД двух чисел
-    static BigInteger gcd(const BigInteger& a, const BigInteger& b) {
-        return std::get<0>(extendedGCD(a, b));
+    // Сырые данные без строк (Serialize.cpp). Порядок слов и байтов в слове -
+    // как order и endian у mpz_import/mpz_export
+    enum class WordOrder { LeastFirst, MostFirst };
+    enum class ByteOrder { Little, Big, Native };
+
+    // Число из лимбов (младший первый), старшие нули допустимы
+    static BigInteger fromLimbs(std::span<const bi_limb_t> limbs, bool negative = false);
+
+    // Модуль из data.size() / wordSize слов по wordSize байт (остаток data - std::invalid_argument)
+    static BigInteger importBytes(std::span<const std::byte> data, size_t wordSize,
+                                  WordOrder order = WordOrder::LeastFirst,
+                                  ByteOrder endian = ByteOrder::Native, bool negative = false);
+
+    // Сколько слов по wordSize байт нужно под |x| (у нуля 0)
+    size_t exportSize(size_t wordSize) const;
+
+    // Пишет |x| в out ровно exportSize(wordSize) словами и возвращает их число.
+    // Знак не пишется. Мало места - std::length_error
+    size_t exportBytes(std::span<std::byte> out, size_t wordSize,
+                       WordOrder order = WordOrder::LeastFirst,
+                       ByteOrder endian = ByteOrder::Native) const;
+
+    // Двоичный формат: заголовок 32 байта и лимбы как есть в little-endian.
+    // Такой файл можно отобразить в память (MappedBigInteger.h) и работать с лимбами
+    // без разбора. Испорченный или чужой файл - std::runtime_error
+    void writeBinary(std::ostream& out) const;
+    static BigInteger readBinary(std::istream& in);
+
+    // Сравнение - через виды, с видами сравнивается так же
+    std::strong_ordering operator<=>(const BigInteger& other) const {
+        return BigIntegerView(*this) <=> BigIntegerView(other);
+    }
+    bool operator==(const BigInteger& other) const {
+        return BigIntegerView(*this) == BigIntegerView(other);
     }
 
+    // Расширенный алгоритм Евклида: {g, x, y} с a * x + b * y = g, g = НОД(|a|, |b|) >= 0,
+    // |x| <= |b| / 2g (GCD.cpp). НОД(0, 0) = 0 с коэффициентами {1, 0}
+    static std::tuple<BigInteger, BigInteger, BigInteger> extendedGCD(const BigInteger& a, const BigInteger& b);
+
+    // НОД двух чисел, всегда неотрицательный. Коэффициенты Безу не считает
+    static BigInteger gcd(const BigInteger& a, const BigInteger& b);
+
+    // Обратный по модулю mod > 0, результат в [0, mod). Если НОД(this, mod) != 1 -
+    // std::runtime_error, если mod <= 0 - std::invalid_argument
+    BigInteger modInverse(const BigInteger& mod) const;
+
     // НОК двух чисел
     static BigInteger lcm(const BigInteger& a, const BigInteger& b) {
         if (a.isZero() || b.isZero()) return BigInteger(0);
@@ -150,12 +490,43 @@ public:
         return res;
     }
 
+    // Пакетные операции (Batch.cpp) сбалансированным деревом: множители на каждом
+    // уровне примерно равной длины, так что работает быстрое умножение, а не
+    // школьное на длинное и короткое. При setThreadCount > 1 большие поддеревья
+    // считаются параллельно, результат от этого не зависит
+    static BigInteger product(std::span<const BigInteger> values);     // пустое - 1
+    static BigInteger sum(std::span<const BigInteger> values);         // пустое - 0
+
+    // x % m_i для всех модулей деревом остатков (знак как у x, как у %).
+    // Нулевой модуль - std::runtime_error
+    static std::vector<BigInteger> remainders(const BigInteger& x, std::span<const BigInteger> moduli);
+
+    static BigInteger factorial(unsigned long long n);
+    static BigInteger binomial(unsigned long long n, unsigned long long k);    // k > n - 0
+
     friend std::ostream& operator<<(std::ostream& stream, const BigInteger& bigint);
+
+    // Разбор десятичного числа из [first, last) в стиле std::from_chars:
+    // необязательный минус и максимальная серия цифр, без исключений
+    friend std::from_chars_result from_chars(const char* first, const char* last, BigInteger& value);
+
+    // Запись в буфер вызывающего в стиле std::to_chars, без выделения памяти под строку.
+    // Если места не хватает - {last, std::errc::value_too_large}
+    friend std::to_chars_result to_chars(char* first, char* last, const BigInteger& value, int base);
+    friend std::to_chars_result to_chars(char* first, char* last, const BigInteger& value) {
+        return to_chars(first, last, value, 10);
+    }
 };
 
+BigInteger operator+(BigIntegerView a, BigIntegerView b);
+BigInteger operator-(BigIntegerView a, BigIntegerView b);
+BigInteger operator*(BigIntegerView a, BigIntegerView b);
+BigInteger operator/(BigIntegerView a, BigIntegerView b);
+BigInteger operator%(BigIntegerView a, BigIntegerView b);
+
 // Литерал для строковых констант (для очень больших чисел)
-inline BigInteger operator"" _bi(const char* str, std::size_t) {
-    return BigInteger(std::string(str));
+inline BigInteger operator"" _bi(const char* str, std::size_t len) {
+    return BigInteger(std::string_view(str, len));
 }
 
 // Литерал для чисел типа unsigned long long (для обычных целых)
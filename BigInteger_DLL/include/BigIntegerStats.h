@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/** namespace stats
+ *  счётчики горячих путей: сколько раз вызывался каждый алгоритм и на каких
+ *  длинах, сколько тактов он занял, сколько было выделений памяти под лимбы.
+ *
+ *  Собирается всегда, а считает только при сборке с -DBIGINTEGER_STATS=ON
+ *  (иначе снимок - одни нули и вызовы в алгоритмах не компилируются вовсе).
+ *  Счётчики атомарные, snapshot() и reset() можно звать из любого потока
+ *  на ходу, но снимок не мгновенный: счётчики читаются по одному.
+ */
+namespace stats {
+
+enum class Algo : unsigned {
+    SchoolMul, SchoolSqr, Karatsuba, Toom3, Toom4, Unbalanced, NTT,
+    DivLimb, DivKnuth, DivBZ,
+    Lehmer, HalfGcd,
+    Redc, Barrett,
+    Parse, Format,
+    Count
+};
+
+constexpr size_t ALGO_COUNT = static_cast<size_t>(Algo::Count);
+
+// Корзина i - длины [2^i, 2^(i+1)) лимбов, последняя - всё, что длиннее
+constexpr size_t SIZE_BUCKETS = 32;
+
+struct Snapshot {
+    // Длина - та, по которой выбирается алгоритм: меньший множитель, делитель,
+    // большее из чисел в НОД, модуль в REDC/Барретте
+    std::array<std::array<uint64_t, SIZE_BUCKETS>, ALGO_COUNT> calls{};
+    // Собственные такты (rdtsc) без вложенных вызовов из того же потока.
+    // Поддеревья, ушедшие в пул потоков, считаются отдельно, а ожидание их - у родителя
+    std::array<uint64_t, ALGO_COUNT> cycles{};
+    uint64_t allocations = 0;           // выделения в куче под LimbVector и арену
+    uint64_t allocatedBytes = 0;
+
+    uint64_t totalCalls(Algo algo) const;
+};
+
+bool enabled();                         // собрано ли с BIGINTEGER_STATS
+Snapshot snapshot();
+void reset();
+
+const char* name(Algo algo);            // "karatsuba", "div_bz", ...
+size_t sizeBucket(size_t limbs);
+
+void countAllocation(size_t bytes);
+
+} // namespace stats
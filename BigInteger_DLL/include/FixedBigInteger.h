@@ -0,0 +1,249 @@
+#pragma once
+
+#include <array>
+#include <compare>
+#include <stdexcept>
+
+#include "BigInteger.h"
+
+/** class FixedBigInteger
+ *  unsigned integer of a fixed width Bits (multiple of 64)
+ *
+ *  Лимбы лежат в std::array прямо в объекте: ни кучи, ни длины, циклы с
+ *  известным числом шагов разворачиваются в прямой код. Всё, кроме перевода
+ *  из/в BigInteger, работает в constexpr. Числа беззнаковые.
+ *  Wrap = false - переполнение, заём и отрицательный аргумент дают
+ *  std::overflow_error (в constexpr - ошибку компиляции). Wrap = true -
+ *  арифметика по модулю 2^Bits, как у встроенных беззнаковых.
+ */
+template <size_t Bits, bool Wrap = false>
+class FixedBigInteger {
+    static_assert(Bits > 0 && Bits % 64 == 0, "FixedBigInteger width must be a positive multiple of 64");
+
+public:
+    using limb_t = BigInteger::bi_limb_t;
+    static constexpr size_t LIMBS = Bits / 64;
+
+    constexpr FixedBigInteger() noexcept = default;
+
+    template <LimbScalar T>
+    constexpr FixedBigInteger(T value) {
+        limbs_[0] = static_cast<limb_t>(value);
+        if constexpr (std::is_signed_v<T>) {
+            if (value < 0) {
+                if constexpr (!Wrap)
+                    throw std::overflow_error("negative value for unsigned FixedBigInteger");
+                for (size_t i = 1; i < LIMBS; ++i)
+                    limbs_[i] = ~limb_t(0);     // -v mod 2^Bits
+            }
+        }
+    }
+
+    // Из более узкого - всегда без потерь, из более широкого - только явно
+    template <size_t OtherBits, bool OtherWrap>
+        requires (OtherBits <= Bits)
+    constexpr FixedBigInteger(const FixedBigInteger<OtherBits, OtherWrap>& other) noexcept {
+        for (size_t i = 0; i < OtherBits / 64; ++i)
+            limbs_[i] = other.limbs()[i];
+    }
+    template <size_t OtherBits, bool OtherWrap>
+        requires (OtherBits > Bits)
+    constexpr explicit FixedBigInteger(const FixedBigInteger<OtherBits, OtherWrap>& other) {
+        for (size_t i = 0; i < LIMBS; ++i)
+            limbs_[i] = other.limbs()[i];
+        if constexpr (!Wrap) {
+            for (size_t i = LIMBS; i < OtherBits / 64; ++i)
+                if (other.limbs()[i])
+                    throw std::overflow_error("value does not fit into FixedBigInteger");
+        }
+    }
+
+    // Из BigInteger или вида на лимбы: не влезает или меньше нуля - как при переполнении
+    explicit FixedBigInteger(BigIntegerView value) {
+        const auto limbs = value.limbs();
+        if constexpr (!Wrap) {
+            if (limbs.size() > LIMBS || value.isNegative())
+                throw std::overflow_error("value does not fit into FixedBigInteger");
+        }
+        for (size_t i = 0; i < LIMBS && i < limbs.size(); ++i)
+            limbs_[i] = limbs[i];
+        if (value.isNegative())
+            *this = FixedBigInteger() - *this;
+    }
+
+    BigInteger toBigInteger() const { return BigInteger::fromLimbs(limbs_); }
+    constexpr BigIntegerView view() const noexcept { return {limbs_.data(), LIMBS}; }
+    constexpr operator BigIntegerView() const noexcept { return view(); }
+
+    constexpr const std::array<limb_t, LIMBS>& limbs() const noexcept { return limbs_; }
+
+    constexpr FixedBigInteger& operator+=(const FixedBigInteger& b) {
+        limb_t carry = 0;
+#pragma GCC unroll 64
+        for (size_t i = 0; i < LIMBS; ++i) {
+            unsigned __int128 s = (unsigned __int128)limbs_[i] + b.limbs_[i] + carry;
+            limbs_[i] = static_cast<limb_t>(s);
+            carry = static_cast<limb_t>(s >> 64);
+        }
+        if constexpr (!Wrap) {
+            if (carry)
+                throw std::overflow_error("FixedBigInteger addition overflow");
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInteger& operator-=(const FixedBigInteger& b) {
+        limb_t borrow = 0;
+#pragma GCC unroll 64
+        for (size_t i = 0; i < LIMBS; ++i) {
+            unsigned __int128 d = (unsigned __int128)limbs_[i] - b.limbs_[i] - borrow;
+            limbs_[i] = static_cast<limb_t>(d);
+            borrow = static_cast<limb_t>(d >> 64) & 1;
+        }
+        if constexpr (!Wrap) {
+            if (borrow)
+                throw std::overflow_error("FixedBigInteger subtraction underflow");
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInteger& operator*=(const FixedBigInteger& b) {
+        if constexpr (Wrap) {
+            // Младшие Bits произведения: строка i нужна только до лимба LIMBS - 1
+            std::array<limb_t, LIMBS> r{};
+#pragma GCC unroll 64
+            for (size_t i = 0; i < LIMBS; ++i) {
+                limb_t carry = 0;
+#pragma GCC unroll 64
+                for (size_t j = 0; i + j < LIMBS; ++j) {
+                    unsigned __int128 t = (unsigned __int128)limbs_[i] * b.limbs_[j] + r[i + j] + carry;
+                    r[i + j] = static_cast<limb_t>(t);
+                    carry = static_cast<limb_t>(t >> 64);
+                }
+            }
+            limbs_ = r;
+        } else {
+            *this = FixedBigInteger(mulFull(b));
+        }
+        return *this;
+    }
+
+    // Полное произведение без потерь, ширина - сумма ширин
+    template <size_t OtherBits, bool OtherWrap>
+    constexpr FixedBigInteger<Bits + OtherBits, Wrap>
+    mulFull(const FixedBigInteger<OtherBits, OtherWrap>& b) const noexcept {
+        constexpr size_t M = OtherBits / 64;
+        std::array<limb_t, LIMBS + M> r{};
+#pragma GCC unroll 64
+        for (size_t i = 0; i < LIMBS; ++i) {
+            limb_t carry = 0;
+#pragma GCC unroll 64
+            for (size_t j = 0; j < M; ++j) {
+                unsigned __int128 t = (unsigned __int128)limbs_[i] * b.limbs()[j] + r[i + j] + carry;
+                r[i + j] = static_cast<limb_t>(t);
+                carry = static_cast<limb_t>(t >> 64);
+            }
+            r[i + M] = carry;
+        }
+        return FixedBigInteger<Bits + OtherBits, Wrap>::fromLimbs(r);
+    }
+
+    static constexpr FixedBigInteger fromLimbs(const std::array<limb_t, LIMBS>& limbs) noexcept {
+        FixedBigInteger res;
+        res.limbs_ = limbs;
+        return res;
+    }
+
+    friend constexpr FixedBigInteger operator+(FixedBigInteger a, const FixedBigInteger& b) { return a += b; }
+    friend constexpr FixedBigInteger operator-(FixedBigInteger a, const FixedBigInteger& b) { return a -= b; }
+    friend constexpr FixedBigInteger operator*(FixedBigInteger a, const FixedBigInteger& b) { return a *= b; }
+
+    friend constexpr bool operator==(const FixedBigInteger& a, const FixedBigInteger& b) noexcept = default;
+    friend constexpr std::strong_ordering operator<=>(const FixedBigInteger& a, const FixedBigInteger& b) noexcept {
+        for (size_t i = LIMBS; i-- > 0;) {
+            if (a.limbs_[i] != b.limbs_[i])
+                return a.limbs_[i] <=> b.limbs_[i];
+        }
+        return std::strong_ordering::equal;
+    }
+
+    friend std::ostream& operator<<(std::ostream& stream, const FixedBigInteger& x) {
+        return stream << x.toBigInteger();
+    }
+
+private:
+    std::array<limb_t, LIMBS> limbs_{};
+};
+
+namespace fixed_literal {
+
+// Разбор целого литерала (десятичный, 0x, 0b, восьмеричный с 0, разделители ')
+// в массив из N лимбов во время компиляции
+template <size_t N>
+struct Parsed {
+    std::array<BigInteger::bi_limb_t, N> limbs{};
+    size_t size = 0;        // лимбов без старших нулей
+};
+
+template <char... Chars>
+constexpr auto parse() {
+    constexpr size_t N = (sizeof...(Chars) * 4 + 63) / 64 + 1;
+    constexpr char digits[] = {Chars...};
+    Parsed<N> res;
+
+    size_t i = 0;
+    unsigned base = 10;
+    if (sizeof...(Chars) > 1 && digits[0] == '0') {
+        if (digits[1] == 'x' || digits[1] == 'X') {
+            base = 16;
+            i = 2;
+        } else if (digits[1] == 'b' || digits[1] == 'B') {
+            base = 2;
+            i = 2;
+        } else {
+            base = 8;
+            i = 1;
+        }
+    }
+
+    bool digitSeen = i == 1;        // у восьмеричного ведущий 0 - уже цифра
+    for (; i < sizeof...(Chars); ++i) {
+        const char c = digits[i];
+        if (c == '\'')
+            continue;
+        // Сюда приходят и литералы с плавающей точкой (1.5_fbi, 1e3_fbi): всё, что не цифра
+        // своей системы, - исключение, то есть ошибка компиляции
+        const unsigned d = c >= '0' && c <= '9' ? c - '0'
+                         : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                         : c >= 'A' && c <= 'F' ? c - 'A' + 10 : 16;
+        if (d >= base)
+            throw std::invalid_argument("_fbi: not a digit of the literal's base");
+        digitSeen = true;
+        unsigned __int128 carry = d;
+        for (auto& limb : res.limbs) {
+            unsigned __int128 t = (unsigned __int128)limb * base + carry;
+            limb = static_cast<BigInteger::bi_limb_t>(t);
+            carry = t >> 64;
+        }
+    }
+    if (!digitSeen)
+        throw std::invalid_argument("_fbi: no digits after the base prefix");
+    res.size = N;
+    while (res.size > 1 && res.limbs[res.size - 1] == 0)
+        --res.size;
+    return res;
+}
+
+} // namespace fixed_literal
+
+// Целый литерал любой длины как FixedBigInteger наименьшей подходящей ширины
+// (кратной 64), дальше он без потерь расширяется до нужной:
+// constexpr FixedBigInteger<256> p = 0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff_fbi;
+template <char... Chars>
+consteval auto operator""_fbi() {
+    constexpr auto parsed = fixed_literal::parse<Chars...>();
+    std::array<BigInteger::bi_limb_t, parsed.size> limbs{};
+    for (size_t i = 0; i < parsed.size; ++i)
+        limbs[i] = parsed.limbs[i];
+    return FixedBigInteger<parsed.size * 64>::fromLimbs(limbs);
+}
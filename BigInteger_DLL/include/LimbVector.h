@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <sys/types.h>
+#include <utility>
+
+#ifdef BIGINTEGER_STATS
+#include "BigIntegerStats.h"
+#endif
+
+/** class LimbVector
+ *  массив лимбов с небольшим буфером внутри объекта (small buffer optimization):
+ *  до INLINE_CAPACITY лимбов живут прямо в BigInteger и не трогают кучу,
+ *  длиннее - переезжают в динамическую память. Интерфейс - подмножество std::vector.
+ */
+class LimbVector {
+public:
+    using value_type = u_int64_t;
+    using size_type = std::size_t;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+
+    static constexpr size_type INLINE_CAPACITY = 2;
+
+    LimbVector() noexcept : size_(0), capacity_(INLINE_CAPACITY) {}
+
+    LimbVector(size_type n, value_type value) : LimbVector() {
+        assign(n, value);
+    }
+
+    LimbVector(const LimbVector& other) : LimbVector() {
+        assign(other.begin(), other.end());
+    }
+
+    LimbVector(LimbVector&& other) noexcept : LimbVector() {
+        steal(other);
+    }
+
+    LimbVector& operator=(const LimbVector& other) {
+        if (this != &other)
+            assign(other.begin(), other.end());     // буфер переиспользуется, если хватает
+        return *this;
+    }
+
+    LimbVector& operator=(LimbVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    ~LimbVector() { release(); }
+
+    value_type* data() noexcept { return isInline() ? inline_ : heap_; }
+    const value_type* data() const noexcept { return isInline() ? inline_ : heap_; }
+
+    size_type size() const noexcept { return size_; }
+    size_type capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    value_type& operator[](size_type i) noexcept { return data()[i]; }
+    const value_type& operator[](size_type i) const noexcept { return data()[i]; }
+    value_type& back() noexcept { return data()[size_ - 1]; }
+    const value_type& back() const noexcept { return data()[size_ - 1]; }
+
+    iterator begin() noexcept { return data(); }
+    iterator end() noexcept { return data() + size_; }
+    const_iterator begin() const noexcept { return data(); }
+    const_iterator end() const noexcept { return data() + size_; }
+
+    void reserve(size_type n) {
+        if (n > capacity_)
+            reallocate(n);
+    }
+
+    void resize(size_type n, value_type value = 0) {
+        reserve(n);
+        if (n > size_)
+            std::fill(data() + size_, data() + n, value);
+        size_ = n;
+    }
+
+    void assign(size_type n, value_type value) {
+        if (n > capacity_) {
+            size_ = 0;          // старое содержимое не нужно, не копируем его
+            reallocate(n);
+        }
+        std::fill(data(), data() + n, value);
+        size_ = n;
+    }
+
+    void assign(const_iterator first, const_iterator last) {
+        size_type n = static_cast<size_type>(last - first);
+        if (n > capacity_) {
+            size_ = 0;
+            reallocate(n);
+        }
+        if (n)
+            std::memmove(data(), first, n * sizeof(value_type));
+        size_ = n;
+    }
+
+    void push_back(value_type value) {
+        if (size_ == capacity_)
+            reallocate(2 * capacity_);
+        data()[size_++] = value;
+    }
+
+    void pop_back() noexcept { --size_; }
+    void clear() noexcept { size_ = 0; }
+
+private:
+    bool isInline() const noexcept { return capacity_ == INLINE_CAPACITY; }
+
+    // Переезд в кучу (или в кучу побольше) с сохранением содержимого
+    void reallocate(size_type n) {
+#ifdef BIGINTEGER_STATS
+        stats::countAllocation(n * sizeof(value_type));
+#endif
+        value_type* fresh = new value_type[n];
+        if (size_)
+            std::memcpy(fresh, data(), size_ * sizeof(value_type));
+        release();
+        heap_ = fresh;
+        capacity_ = n;
+    }
+
+    void release() noexcept {
+        if (!isInline())
+            delete[] heap_;
+        capacity_ = INLINE_CAPACITY;
+    }
+
+    // Забирает буфер other (или копирует встроенный), other остаётся пустым
+    void steal(LimbVector& other) noexcept {
+        if (other.isInline()) {
+            std::copy(other.inline_, other.inline_ + other.size_, inline_);
+        } else {
+            heap_ = other.heap_;
+            capacity_ = other.capacity_;
+            other.capacity_ = INLINE_CAPACITY;
+        }
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+
+    union {
+        value_type inline_[INLINE_CAPACITY];
+        value_type* heap_;
+    };
+    size_type size_;
+    size_type capacity_;    // == INLINE_CAPACITY - данные во встроенном буфере
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+
+#include "BigInteger.h"
+
+/** class MappedBigInteger
+ *  number from a binary file mapped into memory
+ *
+ *  Файл в формате BigInteger::writeBinary отображается только на чтение (mmap),
+ *  лимбы берутся прямо со страниц файла: открытие стоит O(1), в память
+ *  подтягивается только то, что реально читают. Лимбы живут, пока жив объект.
+ *  Нет файла или он испорчен - std::runtime_error.
+ */
+class MappedBigInteger {
+public:
+    using limb_t = BigInteger::bi_limb_t;
+
+    explicit MappedBigInteger(const std::string& path);
+    ~MappedBigInteger();
+
+    MappedBigInteger(MappedBigInteger&& other) noexcept;
+    MappedBigInteger& operator=(MappedBigInteger&& other) noexcept;
+    MappedBigInteger(const MappedBigInteger&) = delete;
+    MappedBigInteger& operator=(const MappedBigInteger&) = delete;
+
+    // Модуль без старших нулей (у нуля пустой) и знак
+    std::span<const limb_t> limbs() const { return {limbs_, size_}; }
+    bool isNegative() const { return negative_; }
+
+    // Вид на отображённые лимбы: арифметика прямо со страниц файла, без копии
+    BigIntegerView view() const { return {limbs_, size_, negative_}; }
+    operator BigIntegerView() const { return view(); }
+
+    // Копия в обычный BigInteger одним memcpy
+    BigInteger toBigInteger() const { return BigInteger(view()); }
+
+private:
+    void unmap() noexcept;
+
+    void* map_ = nullptr;
+    size_t mapSize_ = 0;
+    const limb_t* limbs_ = nullptr;
+    size_t size_ = 0;
+    bool negative_ = false;
+};
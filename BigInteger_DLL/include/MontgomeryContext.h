@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+
+#include "BigInteger.h"
+
+/** class MontgomeryContext
+ *  modular arithmetic for a fixed modulus
+ *
+ *  Строится один раз на модуль m > 0 и дальше переиспользуется. Для нечётного m
+ *  умножение идёт в форме Монтгомери (REDC вместо деления), для чётного -
+ *  с редукцией Барретта. Аргументы - любые целые (в том числе отрицательные),
+ *  результат всегда в [0, m). Методы константные, один контекст можно
+ *  использовать из нескольких потоков сразу.
+ */
+class MontgomeryContext {
+public:
+    using limb_t = BigInteger::bi_limb_t;
+
+    // m <= 0 - std::invalid_argument
+    explicit MontgomeryContext(const BigInteger& modulus);
+
+    const BigInteger& modulus() const { return modulus_; }
+    bool isMontgomery() const { return montgomery_; }   // false - чётный модуль, Барретт
+
+    BigInteger mulmod(const BigInteger& a, const BigInteger& b) const;     // a * b mod m
+    BigInteger sqrmod(const BigInteger& a) const;                          // a^2 mod m
+
+    // base^exp mod m скользящим окном, exp >= 0 (иначе std::invalid_argument)
+    BigInteger modPow(const BigInteger& base, const BigInteger& exp) const;
+
+private:
+    friend class BigInteger;    // тесты простоты считают прямо в представлении
+
+    // С такой длины модуля REDC делаем двумя умножениями, а не построчно
+    static constexpr size_t REDC_MUL_THRESHOLD = 400;
+
+    // Числа внутри - массивы ровно из n_ лимбов. "Представление" - форма
+    // Монтгомери x * R mod m (R = B^n) или просто остаток для Барретта
+    size_t scratchSize() const { return 8 * n_ + 8; }
+    void load(limb_t* rp, const BigInteger& x) const;            // rp = x mod m
+    void toDomain(limb_t* rp, const limb_t* xp, limb_t* tp) const;
+    BigInteger fromDomain(const limb_t* xp, limb_t* tp) const;
+    BigInteger fromLimbs(const limb_t* xp) const;
+    void mul(limb_t* rp, const limb_t* ap, const limb_t* bp, limb_t* tp) const;
+    void reduce(limb_t* rp, limb_t* tp) const;                   // tp[0, 2n) портится
+    void redc(limb_t* rp, limb_t* tp) const;
+    void barrett(limb_t* rp, limb_t* tp) const;
+
+    BigInteger modulus_;
+    size_t n_;
+    bool montgomery_;
+    limb_t minv_ = 0;               // -m^{-1} mod 2^64
+    std::vector<limb_t> minvN_;     // -m^{-1} mod B^n (для REDC умножениями)
+    std::vector<limb_t> r2_;        // R^2 mod m: перевод в форму Монтгомери
+    std::vector<limb_t> one_;       // единица в представлении
+    std::vector<limb_t> mu_;        // floor(B^{2n} / m) для Барретта
+};
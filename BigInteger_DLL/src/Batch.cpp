@@ -0,0 +1,256 @@
+#include "../include/BigInteger.h"
+#include "Parallel.h"
+
+#include <bit>
+
+// Произведения многих чисел деревом: левая свёртка растит один множитель и
+// умножает его на короткие (O(n^2) в сумме), а дерево перемножает равные по
+// длине половины, и получается O(M(n) log n).
+// Факториал и биномиальный коэффициент собираются из разложения на простые
+// (показатели по Лежандру): простые с одинаковым битом показателя перемножаются
+// деревом, а сами биты - схемой Горнера по квадратам, как у GMP. Двойка
+// добавляется одним сдвигом в конце.
+
+namespace {
+
+using limb_t = BigInteger::bi_limb_t;
+
+// До стольких множителей в листе просто сворачиваем
+constexpr size_t PRODUCT_LEAF = 16;
+// До стольких целых в листе отрезка копим произведение в лимбе
+constexpr unsigned long long RANGE_LEAF = 64;
+// Решето до n дольше самого C(n, k) при маленьком k: тогда делим произведения отрезков
+constexpr unsigned long long SIEVE_LIMIT = 1ull << 32;
+// С такой оценки длины (в лимбах) поддеревья идут задачами пула
+constexpr size_t BATCH_PARALLEL_THRESHOLD = 2048;
+
+// Обе половины, параллельно если включено и есть смысл
+template <typename Left, typename Right>
+void both(bool split, Left&& left, Right&& right) {
+    if (split && parallel::enabled())
+        parallel::invoke({std::function<void()>(left), std::function<void()>(right)});
+    else {
+        left();
+        right();
+    }
+}
+
+size_t limbCount(std::span<const BigInteger> values) {
+    size_t total = 0;
+    for (const BigInteger& v : values)
+        total += v.get_limbs().size();
+    return total;
+}
+
+BigInteger productTree(std::span<const BigInteger> values, size_t limbs) {
+    if (values.size() <= PRODUCT_LEAF) {
+        BigInteger res = values[0];
+        for (size_t i = 1; i < values.size(); ++i)
+            res *= values[i];
+        return res;
+    }
+
+    const size_t half = values.size() / 2;
+    const size_t leftLimbs = limbCount(values.first(half));
+    BigInteger left, right;
+    both(limbs >= BATCH_PARALLEL_THRESHOLD,
+         [&] { left = productTree(values.first(half), leftLimbs); },
+         [&] { right = productTree(values.subspan(half), limbs - leftLimbs); });
+    return std::move(left) * std::move(right);
+}
+
+unsigned long long oddPart(unsigned long long v) {
+    return v >> std::countr_zero(v);
+}
+
+// Произведение нечётных частей lo, lo + 1, ..., hi (lo <= hi, lo > 0)
+BigInteger oddRangeProduct(unsigned long long lo, unsigned long long hi) {
+    if (hi - lo < RANGE_LEAF) {
+        // Пока произведение влезает в лимб - копим его, потом одно mulSmall
+        BigInteger res(1);
+        limb_t acc = 1;
+        for (unsigned long long i = lo;; ++i) {
+            limb_t v = oddPart(i), next;
+            if (__builtin_mul_overflow(acc, v, &next)) {
+                res *= acc;
+                next = v;
+            }
+            acc = next;
+            if (i == hi)
+                break;
+        }
+        res *= acc;
+        return res;
+    }
+
+    const unsigned long long mid = lo + (hi - lo) / 2;
+    const size_t limbs = (hi - lo) / 64 * std::bit_width(hi);
+    BigInteger left, right;
+    both(limbs >= BATCH_PARALLEL_THRESHOLD,
+         [&] { left = oddRangeProduct(lo, mid); },
+         [&] { right = oddRangeProduct(mid + 1, hi); });
+    return std::move(left) * std::move(right);
+}
+
+// Нечётные простые до n решетом по нечётным числам
+std::vector<unsigned long long> oddPrimes(unsigned long long n) {
+    std::vector<unsigned long long> primes;
+    if (n < 3)
+        return primes;
+    std::vector<bool> composite((n - 1) / 2);      // i -> 2i + 3
+    for (unsigned long long i = 0; i < composite.size(); ++i) {
+        if (composite[i])
+            continue;
+        const unsigned long long p = 2 * i + 3;
+        primes.push_back(p);
+        for (unsigned long long j = (p * p - 3) / 2; p <= n / p && j < composite.size(); j += p)
+            composite[j] = true;
+    }
+    return primes;
+}
+
+// Показатель p в n! по Лежандру
+unsigned long long legendre(unsigned long long n, unsigned long long p) {
+    unsigned long long e = 0;
+    for (; n; n /= p)
+        e += n / p;
+    return e;
+}
+
+// prod p^e(p). Числа с битом i в показателе склеиваем в лимбы и перемножаем
+// деревом, дальше r = r^2 * P_i от старшего бита
+template <typename Exponent>
+BigInteger primePowerProduct(const std::vector<unsigned long long>& primes, const Exponent& exponent) {
+    std::vector<unsigned long long> exps(primes.size());
+    unsigned long long all = 0;
+    for (size_t i = 0; i < primes.size(); ++i)
+        all |= exps[i] = exponent(primes[i]);
+
+    BigInteger res(1);
+    for (int bit = std::bit_width(all); bit-- > 0;) {
+        std::vector<BigInteger> packed;
+        limb_t acc = 1;
+        for (size_t i = 0; i < primes.size(); ++i) {
+            if (!((exps[i] >> bit) & 1))
+                continue;
+            limb_t next;
+            if (__builtin_mul_overflow(acc, primes[i], &next)) {
+                packed.push_back(BigInteger::fromLimbs({&acc, 1}));
+                next = primes[i];
+            }
+            acc = next;
+        }
+        packed.push_back(BigInteger::fromLimbs({&acc, 1}));
+
+        res *= res;
+        res *= BigInteger::product(packed);
+    }
+    return res;
+}
+
+} // namespace
+
+BigInteger BigInteger::product(std::span<const BigInteger> values) {
+    if (values.empty())
+        return BigInteger(1);
+    return productTree(values, limbCount(values));
+}
+
+// Сложение линейно по длине и так, дерево ничего не даёт: копим в одном буфере
+// с запасом под переносы, чтобы он не переезжал
+BigInteger BigInteger::sum(std::span<const BigInteger> values) {
+    size_t longest = 0;
+    for (const BigInteger& v : values)
+        longest = std::max(longest, v.limbs_.size());
+
+    BigInteger res;
+    res.limbs_.reserve(longest + std::bit_width(values.size()) / 64 + 1);
+    for (const BigInteger& v : values)
+        res += v;
+    return res;
+}
+
+// Снизу вверх строим уровни произведений модулей, сверху вниз спускаем остаток:
+// в узле r mod (произведение модулей поддерева), в листьях x mod m_i.
+// Каждый уровень - один проход по числам суммарной длины как у x
+std::vector<BigInteger> BigInteger::remainders(const BigInteger& x, std::span<const BigInteger> moduli) {
+    std::vector<std::vector<BigInteger>> levels(1);
+    levels[0].reserve(moduli.size());
+    for (const BigInteger& m : moduli) {
+        if (m.isZero())
+            throw std::runtime_error("Division by zero");
+        BigInteger a = m;
+        a.negative_ = false;
+        levels[0].push_back(std::move(a));
+    }
+    if (moduli.empty())
+        return {};
+
+    const bool split = limbCount(moduli) >= BATCH_PARALLEL_THRESHOLD;
+    while (levels.back().size() > 1) {
+        const std::vector<BigInteger>& below = levels.back();
+        std::vector<BigInteger> above((below.size() + 1) / 2);
+        parallel::forChunks(0, above.size(), split ? 1 : above.size(), [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i)
+                above[i] = 2 * i + 1 < below.size() ? below[2 * i] * below[2 * i + 1] : below[2 * i];
+        });
+        levels.push_back(std::move(above));
+    }
+
+    // Остатки от |x|, знак x ставим в конце
+    BigInteger top = x;
+    top.negative_ = false;
+    std::vector<BigInteger> rems{top % levels.back()[0]};
+    for (size_t level = levels.size() - 1; level-- > 0;) {
+        const std::vector<BigInteger>& mods = levels[level];
+        std::vector<BigInteger> next(mods.size());
+        parallel::forChunks(0, mods.size(), split ? 1 : mods.size(), [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                const BigInteger& r = rems[i / 2];
+                next[i] = cmpAbs(r, mods[i]) < 0 ? r : r % mods[i];
+            }
+        });
+        rems = std::move(next);
+    }
+
+    for (BigInteger& r : rems) {
+        r.negative_ = x.negative_;
+        r.normalize();
+    }
+    return rems;
+}
+
+// n! = 2^(n - popcount(n)) * prod p^(sum n / p^i) по нечётным простым p <= n
+BigInteger BigInteger::factorial(unsigned long long n) {
+    if (n < 2)
+        return BigInteger(1);
+    if (n < RANGE_LEAF)
+        return oddRangeProduct(1, n) << (n - std::popcount(n));
+    return primePowerProduct(oddPrimes(n), [n](unsigned long long p) { return legendre(n, p); })
+           << (n - std::popcount(n));
+}
+
+// Степень двойки в C(n, k) по теореме Куммера: popcount(k) + popcount(n - k) - popcount(n).
+// Остальные простые - по Лежандру, если решето до n по карману, иначе
+// (n - k + 1) ... n / k! с точным делением нечётных частей
+BigInteger BigInteger::binomial(unsigned long long n, unsigned long long k) {
+    if (k > n)
+        return BigInteger(0);
+    k = std::min(k, n - k);
+    if (k == 0)
+        return BigInteger(1);
+
+    const int twos = std::popcount(k) + std::popcount(n - k) - std::popcount(n);
+    if (k >= RANGE_LEAF && n <= SIEVE_LIMIT && k >= n / 16) {
+        auto exponent = [n, k](unsigned long long p) {
+            return legendre(n, p) - legendre(k, p) - legendre(n - k, p);
+        };
+        return primePowerProduct(oddPrimes(n), exponent) << twos;
+    }
+
+    BigInteger numerator, denominator;
+    both(k >= 64 * BATCH_PARALLEL_THRESHOLD,
+         [&] { numerator = oddRangeProduct(n - k + 1, n); },
+         [&] { denominator = oddRangeProduct(1, k); });
+    return (numerator / denominator) << twos;
+}
@@ -1,25 +1,10 @@
 #include "../include/BigInteger.h"
+#include "LimbKernels.h"
+#include "Parallel.h"
+#include "Scratch.h"
+#include "Stats.h"
 
-
-BigInteger::BigInteger(const std::string& str) {
-    negative_ = false;
-    limbs_.clear();
-    if (str.empty()) {
-        limbs_.push_back(0);
-        return;
-    }
-    size_t pos = 0;
-    if (str[0] == '-') {
-        negative_ = true;
-        pos = 1;
-    }
-    *this = BigInteger(0);
-    for (; pos < str.size(); ++pos) {
-        if (!isdigit(str[pos])) 
-            throw std::runtime_error("invalid digit");
-        *this = *this * 10 + (str[pos] - '0');
-    }
-}
+#include <limits>
 
 void BigInteger::normalize() {
     while (limbs_.size() > 1 && limbs_.back() == 0)
@@ -28,270 +13,924 @@ void BigInteger::normalize() {
         negative_ = false;
 }
 
-int BigInteger::cmpAbs(const BigInteger& a, const BigInteger& b) {
-    if (a.limbs_.size() != b.limbs_.size())
-        return a.limbs_.size() < b.limbs_.size() ? -1 : 1;
-
-    for (int i = (int)a.limbs_.size() - 1; i >= 0; i--) {
-        if (a.limbs_[i] != b.limbs_[i])
-            return a.limbs_[i] < b.limbs_[i] ? -1 : 1;
-    }
-    return 0;
+void BigInteger::assignView(BigIntegerView v) {
+    if (v.isZero())
+        limbs_.assign(1, 0);
+    else
+        limbs_.assign(v.data(), v.data() + v.size());
+    negative_ = v.isNegative();
 }
 
-BigInteger BigInteger::addAbs(const BigInteger& a, const BigInteger& b) {
-    BigInteger res;
-    size_t n = std::max(a.limbs_.size(), b.limbs_.size());
-    res.limbs_.resize(n + 1, 0);
-
-    unsigned __int128 carry = 0;
-    for (size_t i = 0; i < n; i++) {
-        unsigned __int128 sum = carry;
-        if (i < a.limbs_.size()) sum += a.limbs_[i];
-        if (i < b.limbs_.size()) sum += b.limbs_[i];
-        res.limbs_[i] = static_cast<bi_limb_t>(sum);
-        carry = sum >> 64;
-    }
-    if (carry) res.limbs_[n] = static_cast<bi_limb_t>(carry);
-
-    res.normalize();
-    return res;
+int BigInteger::cmpAbs(BigIntegerView a, BigIntegerView b) {
+    if (a.size() != b.size())
+        return a.size() < b.size() ? -1 : 1;
+    return mpn::cmp(a.data(), b.data(), a.size());
 }
 
-BigInteger BigInteger::subAbs(const BigInteger& a, const BigInteger& b) {
-    BigInteger res;
-    res.limbs_.resize(a.limbs_.size());
-
-    bi_limb_t borrow = 0;
-    for (size_t i = 0; i < a.limbs_.size(); ++i) {
-        bi_limb_t limb_b = i < b.limbs_.size() ? b.limbs_[i] : 0;
-        u_int64_t ai = a.limbs_[i];
-        
-        // Вычитаем с учётом заёма
-        u_int64_t tmp = ai - limb_b - borrow;
-        res.limbs_[i] = tmp;
-
-        // Обновляем borrow
-        borrow = (ai < limb_b + borrow) ? 1 : 0;
-    }
+// |r| += |b| прямо в буфере r, растём только если не хватает лимбов.
+// b может смотреть в сам r, но тогда он не длиннее r и resize его не двигает
+void BigInteger::addAbsInPlace(BigInteger& r, BigIntegerView b) {
+    size_t m = b.size();
+    if (r.limbs_.size() < m)
+        r.limbs_.resize(m, 0);
+    size_t n = r.limbs_.size();
+
+    bi_limb_t* rp = r.limbs_.data();
+    bi_limb_t carry = mpn::add_n(rp, rp, b.data(), m);
+    carry = mpn::add_1(rp + m, rp + m, n - m, carry);
+    if (carry)
+        r.limbs_.push_back(carry);
+}
 
-    res.normalize();
-    return res;
+// |r| -= |b|, требуется |r| >= |b|
+void BigInteger::subAbsInPlace(BigInteger& r, BigIntegerView b) {
+    size_t m = b.size();
+    size_t n = r.limbs_.size();
+    bi_limb_t* rp = r.limbs_.data();
+    bi_limb_t borrow = mpn::sub_n(rp, rp, b.data(), m);
+    mpn::sub_1(rp + m, rp + m, n - m, borrow);
+    r.normalize();
 }
 
+// |r| = |b| - |r|, требуется |b| >= |r|
+void BigInteger::subAbsReversed(BigInteger& r, BigIntegerView b) {
+    size_t n = r.limbs_.size();
+    size_t m = b.size();
+    r.limbs_.resize(m, 0);
+    bi_limb_t* rp = r.limbs_.data();
+    const bi_limb_t* bp = b.data();
+    bi_limb_t borrow = mpn::sub_n(rp, bp, rp, n);
+    mpn::sub_1(rp + n, bp + n, m - n, borrow);
+    r.normalize();
+}
 
-BigInteger& BigInteger::operator+=(const BigInteger& other) {
-    if (negative_ == other.negative_) {
-        *this = addAbs(*this, other);
+BigInteger& BigInteger::operator+=(BigIntegerView other) {
+    if (negative_ == other.isNegative()) {
+        addAbsInPlace(*this, other);
     } else {
         if (cmpAbs(*this, other) >= 0) {
-            *this = subAbs(*this, other);
+            subAbsInPlace(*this, other);
         } else {
-            *this = subAbs(other, *this);
-            negative_ = other.negative_;
+            subAbsReversed(*this, other);
+            negative_ = other.isNegative();
         }
     }
     normalize();
     return *this;
 }
 
-BigInteger& BigInteger::operator-=(const BigInteger& other) {
-    if (negative_ != other.negative_) {
-        *this = addAbs(*this, other);
+BigInteger& BigInteger::operator-=(BigIntegerView other) {
+    if (negative_ != other.isNegative()) {
+        addAbsInPlace(*this, other);
     } else {
         if (cmpAbs(*this, other) >= 0) {
-            *this = subAbs(*this, other);
+            subAbsInPlace(*this, other);
         } else {
-            *this = subAbs(other, *this);
-            negative_ = !other.negative_;
+            subAbsReversed(*this, other);
+            negative_ = !other.isNegative();
         }
     }
     normalize();
     return *this;
 }
 
-BigInteger BigInteger::schoolMul(const BigInteger& a, const BigInteger& b) {
-    BigInteger res;
-    res.limbs_.assign(a.limbs_.size() + b.limbs_.size(), 0);
-
-    for (size_t i = 0; i < a.limbs_.size(); i++) {
-        unsigned __int128 carry = 0;
-        for (size_t j = 0; j < b.limbs_.size(); j++) {
-            unsigned __int128 temp = (unsigned __int128)a.limbs_[i] * b.limbs_[j] + res.limbs_[i+j] + carry;
-            res.limbs_[i+j] = static_cast<bi_limb_t>(temp);
-            carry = temp >> 64;
-        }
-        res.limbs_[i + b.limbs_.size()] = static_cast<bi_limb_t>(carry);
+namespace {
+
+using limb_t = BigInteger::bi_limb_t;
+
+// Длина i-го куска числа из xn лимбов при разбиении по k (последние могут быть пустыми)
+size_t pieceLen(size_t xn, size_t k, size_t i) {
+    return xn > i * k ? std::min(k, xn - i * k) : 0;
+}
+
+// r[0, rn) = sum x_i s^j по кускам i = first, first + step, ... < parts (j - номер
+// слагаемого), схемой Горнера. Значение обязано поместиться в rn лимбов.
+void horner(limb_t* r, size_t rn, const limb_t* xp, size_t xn, size_t k,
+            size_t first, size_t step, size_t parts, limb_t s) {
+    std::fill(r, r + rn, 0);
+    size_t i = first + (parts - 1 - first) / step * step;
+    for (;; i -= step) {
+        if (s != 1)
+            mpn::mul_1(r, r, rn, s);
+        size_t len = pieceLen(xn, k, i);
+        if (len)
+            mpn::add(r, r, rn, xp + i * k, len);
+        if (i == first)
+            break;
     }
+}
 
-    res.negative_ = a.negative_ != b.negative_;
-    res.normalize();
-    return res;
+// pos = x(t), neg = |x(-t)| для x(y) = sum x_i y^i, возвращает true если x(-t) < 0.
+// Чётную и нечётную части считаем отдельно: x(+-t) = E +- O
+bool evalPair(limb_t* pos, limb_t* neg, const limb_t* xp, size_t xn, size_t k,
+              size_t parts, limb_t t) {
+    const size_t n = k + 1;
+    horner(pos, n, xp, xn, k, 0, 2, parts, t * t);
+    horner(neg, n, xp, xn, k, 1, 2, parts, t * t);
+    if (t != 1)
+        mpn::mul_1(neg, neg, n, t);
+
+    // neg = |E - O|, затем pos = 2E +- |E - O| = E + O
+    bool negative = mpn::cmp(pos, neg, n) < 0;
+    if (negative)
+        mpn::sub_n(neg, neg, pos, n);
+    else
+        mpn::sub_n(neg, pos, neg, n);
+    mpn::lshift(pos, pos, n, 1);
+    if (negative)
+        mpn::add_n(pos, pos, neg, n);
+    else
+        mpn::sub_n(pos, pos, neg, n);
+    return negative;
 }
 
-BigInteger BigInteger::karatsubaMul(const BigInteger& a, const BigInteger& b) {
-    size_t n = std::max(a.limbs_.size(), b.limbs_.size());
-    if (n <= 32) return schoolMul(a, b); // базовый случай
+// Интерполяция в Toom идёт над знаковыми значениями фиксированной ширины L
+// в дополнительном коде: сложение, вычитание и умножение на константу просто
+// по модулю B^L, а точное деление - сдвигом и делением Хенселя.
+void subW(limb_t* w, size_t L, const limb_t* x, size_t xn) {
+    mpn::sub(w, w, L, x, xn);
+}
 
-    size_t k = n / 2;
+void addW(limb_t* w, size_t L, const limb_t* x, size_t xn) {
+    mpn::add(w, w, L, x, xn);
+}
 
-    // Делим числа на старшую и младшую половины
-    BigInteger a1, a0, b1, b0;
-    a0.limbs_ = std::vector<bi_limb_t>(a.limbs_.begin(),
-                                       a.limbs_.begin() + std::min(k, a.limbs_.size()));
-    a1.limbs_ = std::vector<bi_limb_t>(a.limbs_.begin() + std::min(k, a.limbs_.size()),
-                                       a.limbs_.end());
-    b0.limbs_ = std::vector<bi_limb_t>(b.limbs_.begin(),
-                                       b.limbs_.begin() + std::min(k, b.limbs_.size()));
-    b1.limbs_ = std::vector<bi_limb_t>(b.limbs_.begin() + std::min(k, b.limbs_.size()),
-                                       b.limbs_.end());
+// w -= x * c
+void subMulW(limb_t* w, size_t L, const limb_t* x, size_t xn, limb_t c) {
+    limb_t borrow = mpn::submul_1(w, x, xn, c);
+    mpn::sub_1(w + xn, w + xn, L - xn, borrow);
+}
 
-    BigInteger z0 = karatsubaMul(a0, b0);
-    BigInteger z2 = karatsubaMul(a1, b1);
-    BigInteger z1 = karatsubaMul(a0 + a1, b0 + b1) - z0 - z2;
+void negW(limb_t* w, size_t L) {
+    for (size_t i = 0; i < L; ++i)
+        w[i] = ~w[i];
+    mpn::add_1(w, w, L, 1);
+}
 
-    // Результат
-    BigInteger res;
-    res.limbs_.assign(z2.limbs_.size() + 2*k, 0);
-
-    // Добавляем z0
-    {
-        unsigned __int128 carry = 0;
-        for (size_t i = 0; i < z0.limbs_.size() || carry; i++) {
-            if (res.limbs_.size() <= i)
-                res.limbs_.push_back(0);
-            unsigned __int128 cur = res.limbs_[i];
-            unsigned __int128 add = carry + (i < z0.limbs_.size() ? z0.limbs_[i] : 0);
-            unsigned __int128 sum = cur + add;
-            res.limbs_[i] = (bi_limb_t)sum;
-            carry = sum >> 64;
-        }
+// w /= d, деление точное
+void divW(limb_t* w, size_t L, limb_t d) {
+    unsigned s = __builtin_ctzll(d);
+    if (s) {
+        bool negative = w[L - 1] >> 63;
+        mpn::rshift(w, w, L, s);
+        if (negative)
+            w[L - 1] |= ~limb_t(0) << (64 - s);
     }
+    if (d >> s != 1)
+        mpn::divexact_1(w, w, L, d >> s);
+}
 
-    // Добавляем z1 << k
-    {
-        unsigned __int128 carry = 0;
-        for (size_t i = 0; i < z1.limbs_.size() || carry; i++) {
-            size_t pos = i + k;
-            if (res.limbs_.size() <= pos)
-                res.limbs_.push_back(0);
-            unsigned __int128 cur = res.limbs_[pos];
-            unsigned __int128 add = carry + (i < z1.limbs_.size() ? z1.limbs_[i] : 0);
-            unsigned __int128 sum = cur + add;
-            res.limbs_[pos] = (bi_limb_t)sum;
-            carry = sum >> 64;
-        }
+// Произведение значений в точке (первые 2k + 2 лимба) расширяем до ширины L со знаком
+void widenPoint(limb_t* v, size_t L, size_t k, bool negative) {
+    std::fill(v + 2 * k + 2, v + L, 0);
+    if (negative)
+        negW(v, L);
+}
+
+// rp[off, rn) += c (неотрицательное, старшие лимбы за пределами rp нулевые)
+void addAt(limb_t* rp, size_t rn, size_t off, const limb_t* c, size_t cn) {
+    if (off < rn)
+        mpn::add(rp + off, rp + off, rn - off, c, std::min(cn, rn - off));
+}
+
+// Подпроизведения пишут в разные куски памяти, поэтому при split
+// они идут задачами пула, иначе по очереди в этом потоке
+template <typename... Tasks>
+void runProducts(bool split, Tasks&&... tasks) {
+    if (split && parallel::enabled())
+        parallel::invoke({std::function<void()>(tasks)...});
+    else
+        (tasks(), ...);
+}
+
+} // namespace
+
+void BigInteger::schoolMul(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn) {
+    BI_STATS_SCOPE(SchoolMul, bn);
+    rp[an] = mpn::mul_1(rp, ap, an, bp[0]);
+    for (size_t j = 1; j < bn; ++j)
+        rp[an + j] = mpn::addmul_1(rp + j, ap, an, bp[j]);
+}
+
+// rp[0, 2n) = a^2: каждое попарное произведение a_i a_j (i < j) считаем один раз,
+// удваиваем сдвигом и добавляем квадраты лимбов на диагонали
+void BigInteger::schoolSqr(bi_limb_t* rp, const bi_limb_t* ap, size_t n) {
+    BI_STATS_SCOPE(SchoolSqr, n);
+    if (n == 1) {
+        unsigned __int128 sq = (unsigned __int128)ap[0] * ap[0];
+        rp[0] = static_cast<bi_limb_t>(sq);
+        rp[1] = static_cast<bi_limb_t>(sq >> 64);
+        return;
     }
 
-    // Добавляем z2 << (2k)
-    {
-        unsigned __int128 carry = 0;
-        for (size_t i = 0; i < z2.limbs_.size() || carry; i++) {
-            size_t pos = i + 2*k;
-            if (res.limbs_.size() <= pos)
-                res.limbs_.push_back(0);
-            unsigned __int128 cur = res.limbs_[pos];
-            unsigned __int128 add = carry + (i < z2.limbs_.size() ? z2.limbs_[i] : 0);
-            unsigned __int128 sum = cur + add;
-            res.limbs_[pos] = (bi_limb_t)sum;
-            carry = sum >> 64;
-        }
+    rp[0] = 0;
+    rp[n] = mpn::mul_1(rp + 1, ap + 1, n - 1, ap[0]);
+    for (size_t i = 1; i + 1 < n; ++i)
+        rp[n + i] = mpn::addmul_1(rp + 2 * i + 1, ap + i + 1, n - i - 1, ap[i]);
+    rp[2 * n - 1] = mpn::lshift(rp + 1, rp + 1, 2 * n - 2, 1);
+
+    bi_limb_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned __int128 sq = (unsigned __int128)ap[i] * ap[i];
+        unsigned __int128 lo = (unsigned __int128)rp[2 * i] + static_cast<bi_limb_t>(sq) + carry;
+        unsigned __int128 hi = (unsigned __int128)rp[2 * i + 1] + static_cast<bi_limb_t>(sq >> 64) + (lo >> 64);
+        rp[2 * i] = static_cast<bi_limb_t>(lo);
+        rp[2 * i + 1] = static_cast<bi_limb_t>(hi);
+        carry = static_cast<bi_limb_t>(hi >> 64);
     }
+}
 
-    res.negative_ = a.negative_ != b.negative_;
-    res.normalize();
-    return res;
+BigInteger::bi_limb_t BigInteger::divLimb(BigInteger& x, bi_limb_t d) {
+    BI_STATS_SCOPE(DivLimb, x.limbs_.size());
+    bi_limb_t rem = mpn::divrem_1(x.limbs_.data(), x.limbs_.data(), x.limbs_.size(), d);
+    x.normalize();
+    return rem;
 }
 
+void BigInteger::addSmall(bi_limb_t v, bool negative) {
+    bi_limb_t* p = limbs_.data();
+    const size_t n = limbs_.size();
+    if (isZero()) {
+        p[0] = v;
+        negative_ = negative && v != 0;
+    } else if (negative_ == negative) {
+        if (bi_limb_t carry = mpn::add_1(p, p, n, v))
+            limbs_.push_back(carry);
+    } else if (n > 1 || p[0] >= v) {
+        mpn::sub_1(p, p, n, v);
+        normalize();
+    } else {
+        p[0] = v - p[0];        // |x| < v, знак меняется
+        negative_ = negative;
+    }
+}
 
+void BigInteger::mulSmall(bi_limb_t v, bool negative) {
+    if (v == 0) {
+        limbs_.assign(1, 0);
+        negative_ = false;
+        return;
+    }
+    bi_limb_t* p = limbs_.data();
+    if (bi_limb_t carry = mpn::mul_1(p, p, limbs_.size(), v))
+        limbs_.push_back(carry);
+    negative_ = negative_ != negative;
+    normalize();
+}
 
+void BigInteger::divSmall(bi_limb_t v, bool negative) {
+    if (v == 0)
+        throw std::runtime_error("Division by zero");
+    divLimb(*this, v);
+    negative_ = negative_ != negative;
+    normalize();
+}
 
-BigInteger& BigInteger::operator*=(const BigInteger& other) {
-    static MulFunc mulAlgo = [](const BigInteger& a, const BigInteger& b) {
-        size_t n = a.limbs_.size();
-        size_t m = b.limbs_.size();
+void BigInteger::modSmall(bi_limb_t v) {
+    if (v == 0)
+        throw std::runtime_error("Division by zero");
+    bi_limb_t r = mpn::mod_1(limbs_.data(), limbs_.size(), v);
+    limbs_.assign(1, r);
+    normalize();
+}
 
-        if (n <= 32 || m <= 32)
-            return schoolMul(a, b);         // маленькие числа
-        else if (n <= 1024 && m <= 1024)
-            return karatsubaMul(a, b);      // средние числа
-        else
-            return karatsubaMul(a, b);      // для больших пока оставим schoolMul или FFT
+// a = a1 * B^k + a0, z1 = (a0 + a1)(b0 + b1) - z0 - z2. Здесь an <= 2 bn.
+// Для квадрата (bp == ap) все три умножения сами становятся возведениями в квадрат
+void BigInteger::karatsubaMul(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn) {
+    BI_STATS_SCOPE(Karatsuba, bn);
+    const size_t k = (an + 1) / 2;
+    if (bn <= k) {
+        unbalancedMul(rp, ap, an, bp, bn);     // b целиком в младшей половине
+        return;
+    }
+    const size_t a1n = an - k, b1n = bn - k;
+    const size_t rn = an + bn;
+
+    scratch::Frame frame;
+    const bool square = ap == bp && an == bn;
+    bi_limb_t* sa = frame.alloc(k + 1);
+    bi_limb_t* sb = square ? sa : frame.alloc(k + 1);
+    bi_limb_t* z1 = frame.alloc(2 * k + 2);
+
+    sa[k] = mpn::add(sa, ap, k, ap + k, a1n);
+    if (!square)
+        sb[k] = mpn::add(sb, bp, k, bp + k, b1n);
+
+    runProducts(bn >= PARALLEL_THRESHOLD,
+        [&] { mulLimbs(rp, ap, k, bp, k); },                        // z0 -> rp[0, 2k)
+        [&] { mulLimbs(rp + 2 * k, ap + k, a1n, bp + k, b1n); },    // z2 -> rp[2k, rn)
+        [&] { mulLimbs(z1, sa, k + 1, sb, k + 1); });
+
+    mpn::sub(z1, z1, 2 * k + 2, rp, 2 * k);
+    mpn::sub(z1, z1, 2 * k + 2, rp + 2 * k, rn - 2 * k);
+    addAt(rp, rn, k, z1, 2 * k + 2);
+}
+
+// Toom-3: делим на три части, a(x) = a0 + a1 x + a2 x^2, x = B^k,
+// считаем произведение в точках 0, 1, -1, 2, inf (5 умножений вместо 9)
+// и восстанавливаем коэффициенты c0..c4.
+void BigInteger::toom3Mul(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn) {
+    BI_STATS_SCOPE(Toom3, bn);
+    const size_t k = (an + 2) / 3;
+    const size_t rn = an + bn;
+    const size_t L = 2 * k + 3;
+
+    scratch::Frame frame;
+    bi_limb_t* ea1 = frame.alloc(k + 1);
+    bi_limb_t* eam1 = frame.alloc(k + 1);
+    bi_limb_t* ea2 = frame.alloc(k + 1);
+
+    // Вычисление в точках, x(-1) может быть отрицательным.
+    // Для квадрата значения b те же, и умножения в точках - тоже квадраты
+    bool am1Neg = evalPair(ea1, eam1, ap, an, k, 3, 1);
+    horner(ea2, k + 1, ap, an, k, 0, 1, 3, 2);
+
+    bi_limb_t* eb1 = ea1;
+    bi_limb_t* ebm1 = eam1;
+    bi_limb_t* eb2 = ea2;
+    bool bm1Neg = am1Neg;
+    if (ap != bp || an != bn) {
+        eb1 = frame.alloc(k + 1);
+        ebm1 = frame.alloc(k + 1);
+        eb2 = frame.alloc(k + 1);
+        bm1Neg = evalPair(eb1, ebm1, bp, bn, k, 3, 1);
+        horner(eb2, k + 1, bp, bn, k, 0, 1, 3, 2);
+    }
+
+    bi_limb_t* v1 = frame.alloc(L);
+    bi_limb_t* vm1 = frame.alloc(L);
+    bi_limb_t* v2 = frame.alloc(L);
+
+    // v0 и vinf сразу на свои места в rp, середина пока нулевая
+    const size_t a2n = an - 2 * k, b2n = pieceLen(bn, k, 2);
+    const size_t vinfn = b2n ? a2n + b2n : 0;
+    std::fill(rp + 2 * k, rp + rn - vinfn, 0);
+    runProducts(bn >= PARALLEL_THRESHOLD,
+        [&] { mulLimbs(v1, ea1, k + 1, eb1, k + 1); widenPoint(v1, L, k, false); },
+        [&] { mulLimbs(vm1, eam1, k + 1, ebm1, k + 1); widenPoint(vm1, L, k, am1Neg != bm1Neg); },
+        [&] { mulLimbs(v2, ea2, k + 1, eb2, k + 1); widenPoint(v2, L, k, false); },
+        [&] { mulLimbs(rp, ap, k, bp, k); },
+        [&] { if (vinfn) mulLimbs(rp + 4 * k, ap + 2 * k, a2n, bp + 2 * k, b2n); });
+    const bi_limb_t* v0 = rp;
+    const bi_limb_t* vinf = rp + 4 * k;
+
+    // w(t) = v(t) - c0 - c4 t^4
+    subW(v1, L, v0, 2 * k);
+    subW(v1, L, vinf, vinfn);           // w1 = c1 + c2 + c3
+    subW(vm1, L, v0, 2 * k);
+    subW(vm1, L, vinf, vinfn);          // wm1 = -c1 + c2 - c3
+    subW(v2, L, v0, 2 * k);
+    subMulW(v2, L, vinf, vinfn, 16);    // w2 = 2 c1 + 4 c2 + 8 c3
+
+    addW(vm1, L, v1, L);
+    divW(vm1, L, 2);                    // c2
+    subW(v1, L, vm1, L);                // c1 + c3
+    subMulW(v2, L, vm1, L, 4);
+    divW(v2, L, 2);                     // c1 + 4 c3
+    subW(v2, L, v1, L);
+    divW(v2, L, 3);                     // c3
+    subW(v1, L, v2, L);                 // c1
+
+    addAt(rp, rn, k, v1, L);
+    addAt(rp, rn, 2 * k, vm1, L);
+    addAt(rp, rn, 3 * k, v2, L);
+}
+
+// Toom-4: четыре части, точки 0, 1, -1, 2, -2, 3, inf (7 умножений вместо 16).
+// Интерполяция разбивает значения на чётную и нечётную части и делит
+// только на маленькие константы, все деления точные.
+void BigInteger::toom4Mul(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn) {
+    BI_STATS_SCOPE(Toom4, bn);
+    const size_t k = (an + 3) / 4;
+    const size_t rn = an + bn;
+    const size_t L = 2 * k + 3;
+
+    scratch::Frame frame;
+    bi_limb_t* ea[5];   // x(1), x(-1), x(2), x(-2), x(3)
+    bi_limb_t* eb[5];
+    for (int i = 0; i < 5; ++i)
+        ea[i] = frame.alloc(k + 1);
+    bool am1Neg = evalPair(ea[0], ea[1], ap, an, k, 4, 1);
+    bool am2Neg = evalPair(ea[2], ea[3], ap, an, k, 4, 2);
+    horner(ea[4], k + 1, ap, an, k, 0, 1, 4, 3);
+
+    // Для квадрата значения b совпадают со значениями a
+    bool bm1Neg = am1Neg, bm2Neg = am2Neg;
+    std::copy(ea, ea + 5, eb);
+    if (ap != bp || an != bn) {
+        for (int i = 0; i < 5; ++i)
+            eb[i] = frame.alloc(k + 1);
+        bm1Neg = evalPair(eb[0], eb[1], bp, bn, k, 4, 1);
+        bm2Neg = evalPair(eb[2], eb[3], bp, bn, k, 4, 2);
+        horner(eb[4], k + 1, bp, bn, k, 0, 1, 4, 3);
+    }
+
+    bi_limb_t* v1 = frame.alloc(L);
+    bi_limb_t* vm1 = frame.alloc(L);
+    bi_limb_t* v2 = frame.alloc(L);
+    bi_limb_t* vm2 = frame.alloc(L);
+    bi_limb_t* v3 = frame.alloc(L);
+
+    const size_t a3n = an - 3 * k, b3n = pieceLen(bn, k, 3);
+    const size_t vinfn = b3n ? a3n + b3n : 0;
+    std::fill(rp + 2 * k, rp + rn - vinfn, 0);
+    auto point = [&](bi_limb_t* v, int i, bool negative) {
+        mulLimbs(v, ea[i], k + 1, eb[i], k + 1);
+        widenPoint(v, L, k, negative);
     };
+    runProducts(bn >= PARALLEL_THRESHOLD,
+        [&] { point(v1, 0, false); },
+        [&] { point(vm1, 1, am1Neg != bm1Neg); },
+        [&] { point(v2, 2, false); },
+        [&] { point(vm2, 3, am2Neg != bm2Neg); },
+        [&] { point(v3, 4, false); },
+        [&] { mulLimbs(rp, ap, k, bp, k); },
+        [&] { if (vinfn) mulLimbs(rp + 6 * k, ap + 3 * k, a3n, bp + 3 * k, b3n); });
+    const bi_limb_t* v0 = rp;
+    const bi_limb_t* vinf = rp + 6 * k;
+
+    // w(t) = v(t) - c0 - c6 t^6 = c1 t + c2 t^2 + ... + c5 t^5
+    auto strip = [&](bi_limb_t* v, bi_limb_t t6) {
+        subW(v, L, v0, 2 * k);
+        subMulW(v, L, vinf, vinfn, t6);
+    };
+    strip(v1, 1);
+    strip(vm1, 1);
+    strip(v2, 64);
+    strip(vm2, 64);
+    strip(v3, 729);
+
+    addW(vm1, L, v1, L);
+    divW(vm1, L, 2);                    // e1 = c2 + c4
+    subW(v1, L, vm1, L);                // o1 = c1 + c3 + c5
+    addW(vm2, L, v2, L);
+    divW(vm2, L, 2);                    // e2 = 4 c2 + 16 c4
+    subW(v2, L, vm2, L);
+    divW(v2, L, 2);                     // o2 = c1 + 4 c3 + 16 c5
+
+    subMulW(vm2, L, vm1, L, 4);
+    divW(vm2, L, 12);                   // c4
+    subW(vm1, L, vm2, L);               // c2
+
+    subMulW(v3, L, vm1, L, 9);
+    subMulW(v3, L, vm2, L, 81);
+    divW(v3, L, 3);                     // o3 = c1 + 9 c3 + 81 c5
+
+    subW(v2, L, v1, L);
+    divW(v2, L, 3);                     // c3 + 5 c5
+    subW(v3, L, v1, L);
+    divW(v3, L, 8);                     // c3 + 10 c5
+    subW(v3, L, v2, L);
+    divW(v3, L, 5);                     // c5
+    subMulW(v2, L, v3, L, 5);           // c3
+    subW(v1, L, v2, L);
+    subW(v1, L, v3, L);                 // c1
+
+    addAt(rp, rn, k, v1, L);
+    addAt(rp, rn, 2 * k, vm1, L);
+    addAt(rp, rn, 3 * k, v2, L);
+    addAt(rp, rn, 4 * k, vm2, L);
+    addAt(rp, rn, 5 * k, v3, L);
+}
 
+// Сильно несбалансированные множители режем на куски размера меньшего,
+// иначе у Toom половина точек считается от нулевых частей
+void BigInteger::unbalancedMul(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn) {
+    BI_STATS_SCOPE(Unbalanced, bn);
+    const size_t rn = an + bn;
+    mulLimbs(rp, ap, bn, bp, bn);
+    std::fill(rp + 2 * bn, rp + rn, 0);
+
+    scratch::Frame frame;
+    bi_limb_t* prod = frame.alloc(2 * bn);
+    for (size_t from = bn; from < an; from += bn) {
+        size_t len = std::min(bn, an - from);
+        mulLimbs(prod, ap + from, len, bp, bn);
+        mpn::add(rp + from, rp + from, rn - from, prod, len + bn);
+    }
+}
+
+void BigInteger::mulLimbs(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn) {
+    // Старшие нулевые лимбы (бывают у кусков в Toom) не умножаем
+    const size_t rn = an + bn;
+    while (an && ap[an - 1] == 0) --an;
+    while (bn && bp[bn - 1] == 0) --bn;
+    if (!an || !bn) {
+        std::fill(rp, rp + rn, 0);
+        return;
+    }
+    std::fill(rp + an + bn, rp + rn, 0);
+    if (an < bn) {
+        std::swap(ap, bp);
+        std::swap(an, bn);
+    }
+
+    // Один и тот же массив - возводим в квадрат: у школьного свой алгоритм,
+    // остальные сами замечают совпадение аргументов
+    const bool square = ap == bp && an == bn;
+    if (square && an <= KARATSUBA_SQR_THRESHOLD)
+        schoolSqr(rp, ap, an);
+    else if (bn <= KARATSUBA_THRESHOLD)
+        schoolMul(rp, ap, an, bp, bn);          // маленькие числа
+    else if (bn >= NTT_THRESHOLD)
+        nttMul(rp, ap, an, bp, bn);             // большие числа, O(n log n)
+    else if (an > 2 * bn)
+        unbalancedMul(rp, ap, an, bp, bn);
+    else if (bn < TOOM3_THRESHOLD)
+        karatsubaMul(rp, ap, an, bp, bn);       // средние числа
+    else if (bn < TOOM4_THRESHOLD)
+        toom3Mul(rp, ap, an, bp, bn);
+    else
+        toom4Mul(rp, ap, an, bp, bn);
+}
+
+// Оценка сверху временной памяти под всю рекурсию (в лимбах): Карацуба и Toom
+// на каждом уровне берут несколько длин куска, уровни убывают геометрически.
+// NTT держит свои буферы сам, ему нужен только кусок под несбалансированный случай.
+size_t BigInteger::mulScratchSize(size_t an, size_t bn) {
+    size_t n = std::min(an, bn);
+    if (n <= KARATSUBA_THRESHOLD)
+        return 0;
+    if (n >= NTT_THRESHOLD)
+        return 2 * n;
+    return 10 * n + 64;
+}
+
+// Если a и b - один объект, mulLimbs получит один массив и посчитает квадрат
+BigInteger BigInteger::mulAlgo(BigIntegerView a, BigIntegerView b) {
+    const size_t an = a.size(), bn = b.size();
+    BigInteger res;
+    if (!an || !bn)
+        return res;
+    res.limbs_.resize(an + bn);
+
+    // Память под рекурсию заказываем один раз по размерам операндов
+    scratch::Frame frame(mulScratchSize(an, bn));
+    mulLimbs(res.limbs_.data(), a.data(), an, b.data(), bn);
+
+    res.negative_ = a.isNegative() != b.isNegative();
+    res.normalize();
+    return res;
+}
+
+BigInteger& BigInteger::operator*=(BigIntegerView other) {
     *this = mulAlgo(*this, other);
     return *this;
 }
 
-std::pair<BigInteger, BigInteger> BigInteger::divMod(const BigInteger& a, const BigInteger& b) {
-    if (b.isZero())
+// Произведение сразу в свой буфер, если он не совпадает с множителем
+BigInteger& BigInteger::operator=(MulExpr&& product) {
+    const BigInteger& a = product.a_;
+    const BigInteger& b = product.b_;
+    if (this == &a || this == &b)
+        return *this = mulAlgo(a, b);
+
+    const size_t an = a.limbs_.size(), bn = b.limbs_.size();
+    limbs_.resize(an + bn);
+    scratch::Frame frame(mulScratchSize(an, bn));
+    mulLimbs(limbs_.data(), a.limbs_.data(), an, b.limbs_.data(), bn);
+    negative_ = a.negative_ != b.negative_;
+    normalize();
+    return *this;
+}
+
+// *this += a * b (или -= при subtract). Если один множитель - лимб, это один
+// проход addmul_1/submul_1 по своему буферу, иначе произведение кладём в арену
+void BigInteger::addProduct(const BigInteger& a, const BigInteger& b, bool subtract) {
+    if (a.isZero() || b.isZero())
+        return;
+    const bool productNegative = (a.negative_ != b.negative_) != subtract;
+    const BigInteger* x = &a;
+    const BigInteger* y = &b;
+    if (x->limbs_.size() < y->limbs_.size())
+        std::swap(x, y);
+    const size_t xn = x->limbs_.size(), yn = y->limbs_.size();
+    const size_t tn = limbs_.size();
+    const bool sameSign = isZero() || negative_ == productNegative;
+
+    if (yn == 1 && (sameSign || tn > xn + 1)) {
+        // При разных знаках |this| >= B^{xn+1} > |x * v|, знак не меняется
+        const bi_limb_t v = y->limbs_[0];
+        if (sameSign) {
+            limbs_.resize(std::max(tn, xn + 1) + 1, 0);
+            bi_limb_t* rp = limbs_.data();
+            bi_limb_t carry = mpn::addmul_1(rp, x->limbs_.data(), xn, v);
+            mpn::add_1(rp + xn, rp + xn, limbs_.size() - xn, carry);
+            negative_ = productNegative;
+        } else {
+            bi_limb_t* rp = limbs_.data();
+            bi_limb_t borrow = mpn::submul_1(rp, x->limbs_.data(), xn, v);
+            mpn::sub_1(rp + xn, rp + xn, tn - xn, borrow);
+        }
+        normalize();
+        return;
+    }
+
+    scratch::Frame frame(mulScratchSize(xn, yn));
+    bi_limb_t* pp = frame.alloc(xn + yn);
+    mulLimbs(pp, x->limbs_.data(), xn, y->limbs_.data(), yn);
+    size_t pn = xn + yn;
+    while (pp[pn - 1] == 0)
+        --pn;
+
+    if (sameSign) {
+        limbs_.resize(std::max(tn, pn) + 1, 0);
+        bi_limb_t* rp = limbs_.data();
+        if (tn >= pn)
+            rp[tn] = mpn::add(rp, rp, tn, pp, pn);
+        else
+            rp[pn] = mpn::add(rp, pp, pn, rp, tn);
+        negative_ = productNegative;
+    } else if (tn > pn || (tn == pn && mpn::cmp(limbs_.data(), pp, pn) >= 0)) {
+        bi_limb_t* rp = limbs_.data();
+        mpn::sub(rp, rp, tn, pp, pn);
+    } else {
+        limbs_.resize(pn, 0);
+        bi_limb_t* rp = limbs_.data();
+        mpn::sub(rp, pp, pn, rp, tn);       // |a * b| - |this|, знак как у произведения
+        negative_ = productNegative;
+    }
+    normalize();
+}
+
+BigInteger BigInteger::fusedProduct(const BigInteger& c, const BigInteger& a, const BigInteger& b,
+                                    bool subtract) {
+    BigInteger result;
+    result.limbs_.reserve(std::max(c.limbs_.size(), a.limbs_.size() + b.limbs_.size()) + 1);
+    result = c;     // буфер уже с запасом под перенос
+    result.addProduct(a, b, subtract);
+    return result;
+}
+
+// (a * b) % m: произведение и частное живут в арене, в кучу идёт только остаток.
+// Для длинного делителя - обычный путь через divMod
+BigInteger BigInteger::mulRem(const BigInteger& a, const BigInteger& b, const BigInteger& m) {
+    if (m.isZero())
         throw std::runtime_error("Division by zero");
+    const size_t an = a.limbs_.size(), bn = b.limbs_.size(), n = m.limbs_.size();
+    if (n >= BZ_THRESHOLD && an + bn >= n + BZ_THRESHOLD) {
+        BigInteger product = mulAlgo(a, b);
+        return std::move(product %= m);
+    }
 
-    BigInteger dividend = a;
-    BigInteger divisor = b;
-    dividend.negative_ = false;
-    divisor.negative_ = false;
-
-    if (cmpAbs(dividend, divisor) < 0)
-        return {BigInteger(0), dividend};
-
-    BigInteger quotient;
-    quotient.limbs_.resize(dividend.limbs_.size(), 0);
-    BigInteger remainder;
-
-    // long division
-    for (int i = dividend.limbs_.size() - 1; i >= 0; --i) {
-        // сдвигаем remainder на лимб
-        remainder.limbs_.insert(remainder.limbs_.begin(), dividend.limbs_[i]);
-        remainder.normalize();
-
-        bi_limb_t q = 0;
-        bi_limb_t left = 0, right = ULONG_LONG_MAX;
-
-        // бинарный поиск для q
-        while (left <= right) {
-            bi_limb_t mid = left + (right - left) / 2;
-            BigInteger t = divisor * BigInteger(mid);
-            if (cmpAbs(t, remainder) <= 0) {
-                q = mid;
-                left = mid + 1;
-            } else {
-                right = mid - 1;
-            }
+    scratch::Frame frame(mulScratchSize(an, bn));
+    bi_limb_t* u = frame.alloc(an + bn + 1);
+    mulLimbs(u, a.limbs_.data(), an, b.limbs_.data(), bn);
+    size_t un = an + bn;
+    while (un > 1 && u[un - 1] == 0)
+        --un;
+
+    const bi_limb_t* mp = m.limbs_.data();
+    BigInteger rem;
+    if (n == 1) {
+        rem.limbs_[0] = mpn::mod_1(u, un, mp[0]);
+    } else if (un < n || (un == n && mpn::cmp(u, mp, n) < 0)) {
+        rem.limbs_.assign(u, u + un);
+    } else {
+        // Как в divSchool: нормализуем сдвигом и делим Кнутом
+        const unsigned shift = __builtin_clzll(mp[n - 1]);
+        bi_limb_t* v = frame.alloc(n);
+        bi_limb_t* q = frame.alloc(un + 1 - n);
+        if (shift) {
+            mpn::lshift(v, mp, n, shift);
+            u[un] = mpn::lshift(u, u, un, shift);
+        } else {
+            std::copy(mp, mp + n, v);
+            u[un] = 0;
         }
+        divKnuth(q, u, un + 1, v, n);
+        rem.limbs_.resize(n);
+        if (shift)
+            mpn::rshift(rem.limbs_.data(), u, n, shift);
+        else
+            std::copy(u, u + n, rem.limbs_.begin());
+    }
+    rem.negative_ = a.negative_ != b.negative_;     // знак остатка как у делимого
+    rem.normalize();
+    return rem;
+}
 
-        remainder -= divisor * BigInteger(q);
-        quotient.limbs_[i] = q;
+// Алгоритм D из Кнута (TAOCP т.2, 4.3.1). Делитель vp из n >= 2 лимбов нормализован
+// (старший бит = 1), старшие n лимбов up меньше делителя. Тогда оценка очередной
+// цифры частного по двум старшим лимбам делится на обратный к старшему лимбу
+// делителя без настоящего деления и ошибается не больше чем на 2.
+// qp[0, un - n) - частное, остаток в up[0, n), остальное up обнуляется.
+void BigInteger::divKnuth(bi_limb_t* qp, bi_limb_t* up, size_t un, const bi_limb_t* vp, size_t n) {
+    BI_STATS_SCOPE(DivKnuth, n);
+    const bi_limb_t d1 = vp[n - 1], d0 = vp[n - 2];
+    const bi_limb_t dinv = mpn::invert_limb(d1);
+
+    for (size_t j = un - n; j-- > 0;) {
+        bi_limb_t u2 = up[j + n], u1 = up[j + n - 1], u0 = up[j + n - 2];
+        bi_limb_t qhat, rhat;
+        bool rhatOverflow;
+
+        if (u2 >= d1) {
+            // u2 == d1, частное по двум лимбам не помещается в лимб
+            qhat = ~bi_limb_t(0);
+            rhat = u1 + d1;
+            rhatOverflow = rhat < d1;
+        } else {
+            qhat = mpn::div2by1(rhat, u2, u1, d1, dinv);
+            rhatOverflow = false;
+        }
+
+        // Уточняем оценку по второму лимбу делителя
+        while (!rhatOverflow &&
+               (unsigned __int128)qhat * d0 > (((unsigned __int128)rhat << 64) | u0)) {
+            --qhat;
+            rhat += d1;
+            rhatOverflow = rhat < d1;
+        }
+
+        // up[j .. j+n] -= qhat * v, при переборе возвращаем v обратно
+        bi_limb_t borrow = mpn::submul_1(up + j, vp, n, qhat);
+        if (up[j + n] < borrow) {
+            --qhat;
+            mpn::add_n(up + j, up + j, vp, n);
+        }
+        up[j + n] = 0;
+        qp[j] = qhat;
     }
+}
+
+// Деление модулей квадратичным методом: тривиальные случаи, деление на лимб, Кнут
+std::pair<BigInteger, BigInteger> BigInteger::divSchool(BigIntegerView a, BigIntegerView b) {
+    if (cmpAbs(a, b) < 0)
+        return {BigInteger(0), BigInteger(a.abs())};
+    if (b.size() == 1) {
+        BigInteger q(a.abs());
+        bi_limb_t r = divLimb(q, b.data()[0]);
+        BigInteger rem(0);
+        rem.limbs_[0] = r;
+        return {q, rem};
+    }
+
+    // Нормализуем сдвигом, чтобы старший бит делителя был 1
+    const size_t an = a.size();
+    const size_t n = b.size();
+    const unsigned shift = __builtin_clzll(b.data()[n - 1]);
+
+    scratch::Frame frame;
+    bi_limb_t* u = frame.alloc(an + 1);
+    bi_limb_t* v = frame.alloc(n);
+    if (shift) {
+        mpn::lshift(v, b.data(), n, shift);
+        u[an] = mpn::lshift(u, a.data(), an, shift);
+    } else {
+        std::copy(b.data(), b.data() + n, v);
+        std::copy(a.data(), a.data() + an, u);
+        u[an] = 0;
+    }
+
+    BigInteger quotient, remainder;
+    quotient.limbs_.resize(an + 1 - n);
+    divKnuth(quotient.limbs_.data(), u, an + 1, v, n);
 
-    quotient.negative_ = a.negative_ != b.negative_;
-    remainder.negative_ = a.negative_;
+    remainder.limbs_.resize(n);
+    if (shift)
+        mpn::rshift(remainder.limbs_.data(), u, n, shift);
+    else
+        std::copy(u, u + n, remainder.limbs_.begin());
 
     quotient.normalize();
     remainder.normalize();
+    return {quotient, remainder};
+}
+
+// Burnikel-Ziegler, "Fast Recursive Division" (1998).
+// b нормализован (старший бит = 1) и состоит из n лимбов, a из 2n лимбов и a < b * B^n.
+// Частное n лимбов в qp, остаток в ap[0, n).
+void BigInteger::div2n1n(bi_limb_t* qp, bi_limb_t* ap, const bi_limb_t* bp, size_t n) {
+    if (n % 2 || n <= BZ_THRESHOLD) {
+        divKnuth(qp, ap, 2 * n, bp, n);
+        return;
+    }
+
+    // Старшие три четверти a делим на b, потом остаток вместе с последней четвертью
+    size_t h = n / 2;
+    div3n2n(qp + h, ap + h, bp, h);
+    div3n2n(qp, ap, bp, h);
+}
+
+// a из трёх половин (по h лимбов), b = b1 * B^h + b0, a < b * B^h.
+// Частное h лимбов в qp, остаток в ap[0, 2h).
+void BigInteger::div3n2n(bi_limb_t* qp, bi_limb_t* ap, const bi_limb_t* bp, size_t h) {
+    const bi_limb_t* b1 = bp + h;
+
+    if (mpn::cmp(ap + 2 * h, b1, h) < 0) {
+        div2n1n(qp, ap + h, b1, h);                 // r1 в ap[h, 2h)
+    } else {
+        // Старшая половина a равна b1: q = B^h - 1, r1 = a12 - b1 * B^h + b1
+        std::fill(qp, qp + h, ~bi_limb_t(0));
+        mpn::sub_n(ap + 2 * h, ap + 2 * h, b1, h);
+        mpn::add(ap + h, ap + h, 2 * h, b1, h);
+    }
+
+    // r = r1 * B^h + a3 - q * b0, пока отрицательный - правим q
+    scratch::Frame frame;
+    bi_limb_t* d = frame.alloc(2 * h);
+    mulLimbs(d, qp, h, bp, h);
+    bi_limb_t borrow = mpn::sub(ap, ap, 3 * h, d, 2 * h);
+    while (borrow) {
+        mpn::sub_1(qp, qp, h, 1);
+        borrow -= mpn::add(ap, ap, 3 * h, bp, 2 * h);
+    }
+}
+
+std::pair<BigInteger, BigInteger> BigInteger::divBurnikelZiegler(BigIntegerView a, BigIntegerView b) {
+    BI_STATS_SCOPE(DivBZ, b.size());
+    // Дополняем делитель до n = m * 2^k лимбов с m <= BZ_THRESHOLD, чтобы рекурсия
+    // всегда делилась пополам, и нормализуем старший бит
+    const size_t s = b.size();
+    size_t m = s, k = 0;
+    while (m > BZ_THRESHOLD) {
+        m = (m + 1) / 2;
+        ++k;
+    }
+    const size_t n = m << k;
+    const size_t pad = n - s;
+    const unsigned shift = __builtin_clzll(b.data()[b.size() - 1]);
+
+    // Делимое режем на блоки по n лимбов, старший блок (с нулевым старшим лимбом)
+    // меньше делителя. Остаток каждого блока остаётся на месте старшей половины
+    // следующего окна, так что всё деление идёт внутри одного массива.
+    const size_t an = a.size() + pad + 1;
+    const size_t t = std::max<size_t>(2, an / n + 1);
+
+    scratch::Frame frame(t * n + n + 2 * n + mulScratchSize(n, n));
+    bi_limb_t* bn = frame.alloc(n);
+    bi_limb_t* u = frame.alloc(t * n);
+    std::fill(bn, bn + pad, 0);
+    std::fill(u, u + t * n, 0);
+    if (shift) {
+        mpn::lshift(bn + pad, b.data(), s, shift);
+        u[an - 1] = mpn::lshift(u + pad, a.data(), a.size(), shift);
+    } else {
+        std::copy(b.data(), b.data() + s, bn + pad);
+        std::copy(a.data(), a.data() + a.size(), u + pad);
+    }
 
+    BigInteger quotient, remainder;
+    quotient.limbs_.resize((t - 1) * n);
+    for (size_t i = t - 1; i-- > 0;)
+        div2n1n(quotient.limbs_.data() + i * n, u + i * n, bn, n);
+
+    // Остаток сдвинут так же, как делимое
+    remainder.limbs_.resize(s);
+    if (shift)
+        mpn::rshift(remainder.limbs_.data(), u + pad, s, shift);
+    else
+        std::copy(u + pad, u + n, remainder.limbs_.begin());
+
+    quotient.normalize();
+    remainder.normalize();
     return {quotient, remainder};
 }
 
+std::pair<BigInteger, BigInteger> BigInteger::divMod(BigIntegerView a, BigIntegerView b) {
+    if (b.isZero())
+        throw std::runtime_error("Division by zero");
 
-BigInteger& BigInteger::operator/=(const BigInteger& other) {
+    std::pair<BigInteger, BigInteger> res;
+    size_t bn = b.size();
+    if (bn < BZ_THRESHOLD || a.size() < bn + BZ_THRESHOLD)
+        res = divSchool(a, b);
+    else
+        res = divBurnikelZiegler(a, b);
+
+    // Деление с отбрасыванием дробной части: знак остатка как у делимого
+    auto& [quotient, remainder] = res;
+    quotient.negative_ = a.isNegative() != b.isNegative();
+    remainder.negative_ = a.isNegative();
+    quotient.normalize();
+    remainder.normalize();
+
+    return res;
+}
+
+BigInteger& BigInteger::operator/=(BigIntegerView other) {
     *this = divMod(*this, other).first;
     return *this;
 }
 
-BigInteger& BigInteger::operator%=(const BigInteger& other) {
+BigInteger& BigInteger::operator%=(BigIntegerView other) {
     *this = divMod(*this, other).second;
     return *this;
 }
 
 BigInteger operator+(const BigInteger& a, const BigInteger& b) {
-    BigInteger result = a;
+    BigInteger result;
+    result.limbs_.reserve(std::max(a.limbs_.size(), b.limbs_.size()) + 1);
+    result = a;     // копирование в уже выделенный буфер, перенос потом влезет
     result += b;
     return result;
 }
 
 BigInteger operator-(const BigInteger& a, const BigInteger& b) {
-    BigInteger result = a;
+    BigInteger result;
+    result.limbs_.reserve(std::max(a.limbs_.size(), b.limbs_.size()) + 1);
+    result = a;
     result -= b;
     return result;
 }
@@ -308,77 +947,159 @@ BigInteger operator%(const BigInteger& a, const BigInteger& b) {
     return result;
 }
 
-BigInteger operator*(const BigInteger& a, const BigInteger& b) {
-    BigInteger result = a;
-    result *= b;
-    return result;
+// Версии для временных объектов: результат пишем в буфер временного
+// вместо копирования, так цепочки вида a + b + c не выделяют память заново
+BigInteger operator+(BigInteger&& a, const BigInteger& b) {
+    a += b;
+    return std::move(a);
 }
 
-BigInteger BigInteger::pow(unsigned long long exp) const {
-    BigInteger result(1);
-    BigInteger base = *this;
-
-    while (exp > 0) {
-        if (exp & 1)
-            result *= base;
-        base *= base;
-        exp >>= 1;
-    }
+BigInteger operator+(const BigInteger& a, BigInteger&& b) {
+    b += a;
+    return std::move(b);
+}
 
-    if (negative_ && (exp & 1))
-        result.negative_ = true;
+BigInteger operator+(BigInteger&& a, BigInteger&& b) {
+    a += b;
+    return std::move(a);
+}
 
-    return result;
+BigInteger operator-(BigInteger&& a, const BigInteger& b) {
+    a -= b;
+    return std::move(a);
 }
 
-std::ostream& operator<<(std::ostream& stream, const BigInteger& bigint) {
-    if (bigint.negative_ && !bigint.isZero()) {
-        stream << "-";
-    }
+BigInteger operator-(const BigInteger& a, BigInteger&& b) {
+    // a - b = -(b - a)
+    b -= a;
+    b.negative_ = !b.negative_;
+    b.normalize();
+    return std::move(b);
+}
 
-    // выводим старший лимб первым (чтобы было как при обычной записи числа)
-    stream << std::hex << bigint.limbs_.back(); 
+BigInteger operator-(BigInteger&& a, BigInteger&& b) {
+    a -= b;
+    return std::move(a);
+}
 
-    // остальные выводим с ведущими нулями до 16 цифр (64 бита = 16 hex символов)
-    for (std::size_t i = bigint.limbs_.size() - 1; i-- > 0;) {
-        stream << std::setfill('0') << std::setw(16) 
-               << std::noshowbase
-               << std::hex << bigint.limbs_[i];
-    }
+BigInteger operator*(BigInteger&& a, const BigInteger& b) {
+    a *= b;
+    return std::move(a);
+}
 
-    // вернем поток в десятичный режим (на всякий случай)
-    stream << std::dec;
+BigInteger operator*(const BigInteger& a, BigInteger&& b) {
+    b *= a;
+    return std::move(b);
+}
 
-    return stream;
+BigInteger operator*(BigInteger&& a, BigInteger&& b) {
+    a *= b;
+    return std::move(a);
 }
 
-// std::ostream& operator<<(std::ostream& stream, const BigInteger& bigint) {
-//     if (bigint.isZero()) {
-//         stream << "0";
-//         return stream;
-//     }
+BigInteger operator/(BigInteger&& a, const BigInteger& b) {
+    a /= b;
+    return std::move(a);
+}
 
-//     // Копируем число, чтобы не портить исходник
-//     BigInteger temp = bigint;
-//     temp.negative_ = false; // работаем только с модулем числа
+BigInteger operator%(BigInteger&& a, const BigInteger& b) {
+    a %= b;
+    return std::move(a);
+}
 
-//     std::string result;
-//     while (!temp.isZero()) {
-//         // Делим temp на 10
-//         auto divmod = BigInteger::divMod(temp, BigInteger(10));
-//         BigInteger q = divmod.first;
-//         BigInteger r = divmod.second;
+// С видами результат всегда новый, операнды читаем на месте
+BigInteger operator+(BigIntegerView a, BigIntegerView b) {
+    BigInteger result;
+    result.limbs_.reserve(std::max(a.size(), b.size()) + 1);
+    result.assignView(a);
+    result += b;
+    return result;
+}
 
-//         // r — остаток (одна цифра)
-//         result.push_back(static_cast<char>('0' + r.limbs_[0]));
-//         temp = std::move(q);
-//     }
+BigInteger operator-(BigIntegerView a, BigIntegerView b) {
+    BigInteger result;
+    result.limbs_.reserve(std::max(a.size(), b.size()) + 1);
+    result.assignView(a);
+    result -= b;
+    return result;
+}
+
+BigInteger operator*(BigIntegerView a, BigIntegerView b) {
+    return BigInteger::mulAlgo(a, b);
+}
 
-//     if (bigint.negative_) result.push_back('-');
+BigInteger operator/(BigIntegerView a, BigIntegerView b) {
+    return BigInteger::divMod(a, b).first;
+}
 
-//     // Сейчас строка в обратном порядке
-//     std::reverse(result.begin(), result.end());
-//     stream << result;
-//     return stream;
-// }
+BigInteger operator%(BigIntegerView a, BigIntegerView b) {
+    return BigInteger::divMod(a, b).second;
+}
 
+// Слева направо с окном: нули показателя - только квадраты, окно из не больше
+// k бит с единицей на конце - одно умножение на нечётную степень из таблицы.
+// Множитель 2^t основания выносим и добавляем в конце одним сдвигом
+BigInteger BigInteger::pow(unsigned long long exp) const {
+    if (exp == 0)
+        return BigInteger(1);
+    if (isZero())
+        return BigInteger(0);
+
+    size_t zeros = 0;
+    while (limbs_[zeros / 64] == 0)
+        zeros += 64;
+    zeros += __builtin_ctzll(limbs_[zeros / 64]);
+    if (zeros && exp > std::numeric_limits<size_t>::max() / zeros)
+        throw std::length_error("pow: result is too large");
+
+    BigInteger base = *this >> zeros;
+    base.negative_ = false;
+
+    BigInteger result;
+    if (base.limbs_.size() == 1 && base.limbs_[0] == 1) {
+        result.setBit(zeros * exp);     // степень двойки: обнулить лимбы и поставить бит
+    } else {
+        const unsigned bits = 64 - __builtin_clzll(exp);
+        const unsigned k = bits > 24 ? 4 : bits > 6 ? 3 : 1;
+        auto bit = [&](unsigned i) { return (exp >> i) & 1; };
+
+        // base^1, base^3, ..., base^{2^k - 1}
+        std::vector<BigInteger> table(size_t(1) << (k - 1));
+        table[0] = base;
+        if (table.size() > 1) {
+            BigInteger square = base * base;
+            for (size_t i = 1; i < table.size(); ++i)
+                table[i] = table[i - 1] * square;
+        }
+
+        bool started = false;
+        unsigned i = bits;
+        while (i > 0) {
+            if (!bit(i - 1)) {
+                result *= result;
+                --i;
+                continue;
+            }
+            unsigned j = i > k ? i - k : 0;
+            while (!bit(j))
+                ++j;
+            size_t window = 0;
+            for (unsigned b = i; b-- > j;)
+                window = window << 1 | bit(b);
+
+            if (!started) {
+                result = table[window >> 1];
+                started = true;
+            } else {
+                for (unsigned s = j; s < i; ++s)
+                    result *= result;
+                result *= table[window >> 1];
+            }
+            i = j;
+        }
+        result <<= zeros * exp;
+    }
+
+    result.negative_ = negative_ && (exp & 1);
+    return result;
+}
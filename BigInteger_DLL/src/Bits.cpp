@@ -0,0 +1,182 @@
+#include "../include/BigInteger.h"
+#include "LimbKernels.h"
+#include "Scratch.h"
+
+#include <limits>
+
+// Сдвиги и побитовые операции. Храним знак и модуль, а отрицательные числа
+// трактуем как дополнительный код -x = ~(x - 1) с бесконечным знаковым битом
+// (как mpz_and, mpz_tstbit и т.д. в GMP). Для неотрицательных - просто циклы
+// по лимбам, для остальных переводим в дополнительный код на n + 1 лимбах.
+
+BigInteger& BigInteger::operator<<=(size_t bits) {
+    if (isZero() || bits == 0)
+        return *this;
+    const size_t n = limbs_.size();
+    const size_t q = bits / 64;
+    const unsigned shift = bits % 64;
+
+    limbs_.resize(n + q + 1, 0);
+    bi_limb_t* p = limbs_.data();
+    // Идём сверху вниз, так что сдвиг на месте ничего не затирает
+    if (shift)
+        p[n + q] = mpn::lshift(p + q, p, n, shift);
+    else
+        std::copy_backward(p, p + n, p + n + q);
+    std::fill(p, p + q, 0);
+    normalize();
+    return *this;
+}
+
+BigInteger& BigInteger::operator>>=(size_t bits) {
+    const size_t n = limbs_.size();
+    const size_t q = bits / 64;
+    const unsigned shift = bits % 64;
+    const bool negative = negative_;
+
+    if (q >= n) {
+        limbs_.assign(1, negative ? 1 : 0);     // -1 для отрицательных, иначе 0
+        return *this;
+    }
+
+    // Округление вниз: у отрицательного модуль растёт на 1, если ушли ненулевые биты
+    bi_limb_t* p = limbs_.data();
+    bool lost = false;
+    if (negative) {
+        lost = shift && (p[q] & ((bi_limb_t(1) << shift) - 1));
+        for (size_t i = 0; i < q && !lost; ++i)
+            lost = p[i] != 0;
+    }
+
+    if (shift)
+        mpn::rshift(p, p + q, n - q, shift);
+    else
+        std::copy(p + q, p + n, p);
+    limbs_.resize(n - q);
+    if (lost) {
+        if (bi_limb_t carry = mpn::add_1(p, p, n - q, 1))
+            limbs_.push_back(carry);
+    }
+    normalize();
+    return *this;
+}
+
+BigInteger BigInteger::operator~() const {
+    BigInteger res = *this;
+    res.negative_ = !negative_;
+    res.addSmall(1, true);      // ~x = -x - 1
+    return res;
+}
+
+void BigInteger::bitwise(BigInteger& r, const BigInteger& b, char op) {
+    const bool rneg = r.negative_, bneg = b.negative_;
+    const size_t rn = r.limbs_.size(), bn = b.limbs_.size();
+
+    if (!rneg && !bneg) {
+        if (op == '&') {
+            const size_t n = std::min(rn, bn);
+            mpn::and_n(r.limbs_.data(), r.limbs_.data(), b.limbs_.data(), n);
+            r.limbs_.resize(n);
+        } else {
+            if (rn < bn)
+                r.limbs_.resize(bn, 0);
+            if (op == '|')
+                mpn::ior_n(r.limbs_.data(), r.limbs_.data(), b.limbs_.data(), bn);
+            else
+                mpn::xor_n(r.limbs_.data(), r.limbs_.data(), b.limbs_.data(), bn);
+        }
+        r.normalize();
+        return;
+    }
+
+    // Лишний лимб сверху - знаковый, у результата его знак совпадает со знаком числа
+    const bool negative = op == '&' ? rneg && bneg
+                        : op == '|' ? rneg || bneg
+                        : rneg != bneg;
+    const size_t n = std::max(rn, bn) + 1;
+    scratch::Frame frame;
+    bi_limb_t* tp = frame.alloc(n);
+    std::copy(b.limbs_.begin(), b.limbs_.end(), tp);     // b может быть самим r
+    std::fill(tp + bn, tp + n, 0);
+    if (bneg)
+        mpn::neg(tp, tp, n);
+
+    r.limbs_.resize(n, 0);
+    bi_limb_t* rp = r.limbs_.data();
+    if (rneg)
+        mpn::neg(rp, rp, n);
+
+    if (op == '&')
+        mpn::and_n(rp, rp, tp, n);
+    else if (op == '|')
+        mpn::ior_n(rp, rp, tp, n);
+    else
+        mpn::xor_n(rp, rp, tp, n);
+
+    if (negative)
+        mpn::neg(rp, rp, n);
+    r.negative_ = negative;
+    r.normalize();
+}
+
+size_t BigInteger::bitLength() const {
+    if (isZero())
+        return 0;
+    return 64 * limbs_.size() - __builtin_clzll(limbs_.back());
+}
+
+size_t BigInteger::popcount() const {
+    if (negative_)
+        return std::numeric_limits<size_t>::max();
+    return mpn::popcount(limbs_.data(), limbs_.size());
+}
+
+size_t BigInteger::trailingZeros() const {
+    if (isZero())
+        return 0;
+    size_t i = 0;
+    while (limbs_[i] == 0)
+        ++i;
+    return 64 * i + __builtin_ctzll(limbs_[i]);
+}
+
+bool BigInteger::testBit(size_t bit) const {
+    const size_t i = bit / 64;
+    const unsigned shift = bit % 64;
+    if (i >= limbs_.size())
+        return negative_;
+    if (!negative_)
+        return (limbs_[i] >> shift) & 1;
+
+    // Бит числа ~(x - 1): заём из x - 1 доходит до младшего ненулевого лимба z.
+    // Ниже z лимбы x - 1 состоят из единиц (в ответе нули), в z лимб уменьшен на 1
+    size_t z = 0;
+    while (limbs_[z] == 0)
+        ++z;
+    if (i < z)
+        return false;
+    bi_limb_t limb = i == z ? limbs_[i] - 1 : limbs_[i];
+    return !((limb >> shift) & 1);
+}
+
+void BigInteger::setBit(size_t bit, bool value) {
+    if (negative_) {
+        BigInteger mask = BigInteger(1) << bit;
+        if (value)
+            *this |= mask;
+        else
+            *this &= ~mask;
+        return;
+    }
+
+    const size_t i = bit / 64;
+    const bi_limb_t mask = bi_limb_t(1) << (bit % 64);
+    if (value) {
+        if (i >= limbs_.size())
+            limbs_.resize(i + 1, 0);
+        limbs_[i] |= mask;
+    } else if (i < limbs_.size()) {
+        limbs_[i] &= ~mask;
+        normalize();
+    }
+}
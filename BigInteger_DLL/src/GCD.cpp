@@ -0,0 +1,392 @@
+#include "../include/BigInteger.h"
+#include "LimbKernels.h"
+#include "Scratch.h"
+#include "Stats.h"
+
+// НОД без деления на каждом шаге.
+// Лемер: по старшим 128 битам пары считаем сразу много частных алгоритма Евклида
+// в машинных словах и собираем их в матрицу M с (a, b) = M (a', b'). Если пара
+// a', b' старших битов не опускается ниже 2^65, а элементы M меньше 2^63, то та же
+// матрица годится и для полных чисел (Möller, "On Schönhage's algorithm and
+// subquadratic integer GCD computation", 2008). Применение M к a и b - один
+// проход по лимбам вместо десятков делений.
+// half-GCD: то же самое рекурсивно - матрицу для старшей половины битов считаем
+// рекурсивно и применяем быстрым умножением, так что весь НОД стоит O(M(n) log n).
+
+namespace {
+
+using limb_t = BigInteger::bi_limb_t;
+using u128 = unsigned __int128;
+
+size_t maxBits(const BigInteger& a, const BigInteger& b) {
+    return std::max(a.bitLength(), b.bitLength());
+}
+
+// Биты [p, p + 128) числа x
+u128 window(const BigInteger& x, size_t p) {
+    auto limbs = x.get_limbs();
+    auto limb = [&](size_t i) -> u128 { return i < limbs.size() ? limbs[i] : 0; };
+    const size_t i = p / 64;
+    const unsigned shift = p % 64;
+    u128 w = (limb(i + 1) << 64) | limb(i);
+    if (shift)
+        w = (w >> shift) | (limb(i + 2) << (128 - shift));
+    return w;
+}
+
+// Матрица из машинных слов для шага Лемера
+struct Matrix2 {
+    limb_t m00 = 1, m01 = 0, m10 = 0, m11 = 1;
+};
+
+// x - q y с наибольшим q, при котором остаток не меньше bound (требуется x - y >= bound)
+u128 subQuotient(u128 x, u128 y, u128 bound, limb_t& q) {
+    u128 r = x - y;
+    q = 1;
+    if (r >= y) {
+        // Частные почти всегда маленькие, длинное деление только для больших
+        if ((r >> 2) < y) {
+            do {
+                r -= y;
+                ++q;
+            } while (r >= y);
+        } else {
+            q += static_cast<limb_t>(r / y);
+            r %= y;
+        }
+    }
+    if (r < bound) {
+        --q;
+        r += y;
+    }
+    return r;
+}
+
+// Шаги Евклида над (x, y), пока оба остаются >= 2^65. Тогда x >= (m00 + m01) 2^65,
+// и элементы M меньше 2^63. Возвращает false, если ни одного шага сделать нельзя
+bool lehmer(u128 x, u128 y, Matrix2& m) {
+    const u128 bound = (u128)1 << 65;
+    if (x < bound || y < bound)
+        return false;
+
+    bool progress = false;
+    for (;;) {
+        limb_t q;
+        if (x >= y) {
+            if (x - y < bound)
+                break;
+            x = subQuotient(x, y, bound, q);
+            m.m01 += q * m.m00;
+            m.m11 += q * m.m10;
+        } else {
+            if (y - x < bound)
+                break;
+            y = subQuotient(y, x, bound, q);
+            m.m00 += q * m.m01;
+            m.m10 += q * m.m11;
+        }
+        progress = true;
+    }
+    return progress;
+}
+
+int ctz128(u128 x) {
+    limb_t lo = static_cast<limb_t>(x);
+    return lo ? __builtin_ctzll(lo) : 64 + __builtin_ctzll(static_cast<limb_t>(x >> 64));
+}
+
+// Бинарный НОД для чисел из двух лимбов
+u128 binaryGcd(u128 x, u128 y) {
+    if (x == 0) return y;
+    if (y == 0) return x;
+    const int shift = ctz128(x | y);
+    x >>= ctz128(x);
+    do {
+        y >>= ctz128(y);
+        if (x > y)
+            std::swap(x, y);
+        y -= x;
+    } while (y);
+    return x << shift;
+}
+
+} // namespace
+
+// Произведение элементарных матриц шагов Евклида, все элементы неотрицательные, det = 1.
+// Для коэффициентов Безу хватает нижней строки (rowOnly), верхнюю тогда не считаем
+struct BigInteger::GcdMatrix {
+    BigInteger m00 = 1, m01 = 0, m10 = 0, m11 = 1;
+    bool rowOnly = false;
+
+    // M = M * N
+    void mul(const GcdMatrix& n) {
+        if (!rowOnly) {
+            BigInteger a00 = m00 * n.m00 + m01 * n.m10;
+            m01 = m00 * n.m01 + m01 * n.m11;
+            m00 = std::move(a00);
+        }
+        BigInteger a10 = m10 * n.m00 + m11 * n.m10;
+        m11 = m10 * n.m01 + m11 * n.m11;
+        m10 = std::move(a10);
+    }
+
+    void mul(const Matrix2& n) {
+        if (!rowOnly) {
+            BigInteger a00 = combine(m00, n.m00, m01, n.m10);
+            m01 = combine(m00, n.m01, m01, n.m11);
+            m00 = std::move(a00);
+        }
+        BigInteger a10 = combine(m10, n.m00, m11, n.m10);
+        m11 = combine(m10, n.m01, m11, n.m11);
+        m10 = std::move(a10);
+    }
+
+    // Учёт шага a -= q b (first) или b -= q a, произведение сразу прибавляется к элементу
+    void subtracted(bool first, const BigInteger& q) {
+        if (first) {
+            if (!rowOnly)
+                m01.addProduct(q, m00, false);
+            m11.addProduct(q, m10, false);
+        } else {
+            if (!rowOnly)
+                m00.addProduct(q, m01, false);
+            m10.addProduct(q, m11, false);
+        }
+    }
+
+    // x u + y v для неотрицательных x, y за два прохода по лимбам
+    static BigInteger combine(const BigInteger& x, bi_limb_t u, const BigInteger& y, bi_limb_t v) {
+        const size_t xn = x.limbs_.size(), yn = y.limbs_.size();
+        const size_t len = std::max(xn, yn) + 1;
+        BigInteger r;
+        r.limbs_.assign(len, 0);
+        bi_limb_t* rp = r.limbs_.data();
+        rp[xn] = mpn::mul_1(rp, x.limbs_.data(), xn, u);
+        bi_limb_t carry = mpn::addmul_1(rp, y.limbs_.data(), yn, v);
+        mpn::add_1(rp + yn, rp + yn, len - yn, carry);
+        r.normalize();
+        return r;
+    }
+};
+
+// high = x >> p, low = x mod 2^p для x >= 0
+void BigInteger::splitBits(const BigInteger& x, size_t p, BigInteger& high, BigInteger& low) {
+    const size_t n = x.limbs_.size();
+    const size_t q = p / 64;
+    const unsigned shift = p % 64;
+
+    const size_t lown = std::min(n, q + (shift ? 1 : 0));
+    low.limbs_.assign(x.limbs_.begin(), x.limbs_.begin() + std::max<size_t>(lown, 1));
+    if (lown == 0)
+        low.limbs_[0] = 0;
+    else if (shift && lown == q + 1)
+        low.limbs_[q] &= (bi_limb_t(1) << shift) - 1;
+    low.negative_ = false;
+    low.normalize();
+
+    high.negative_ = false;
+    if (q >= n) {
+        high.limbs_.assign(1, 0);
+        return;
+    }
+    high.limbs_.resize(n - q);
+    if (shift)
+        mpn::rshift(high.limbs_.data(), x.limbs_.data() + q, n - q, shift);
+    else
+        std::copy(x.limbs_.begin() + q, x.limbs_.end(), high.limbs_.begin());
+    high.normalize();
+}
+
+// Один шаг редукции (a, b) >= 0, не опускаясь ниже 2^s (при s > 0 оба числа уже >= 2^s).
+// Сначала Лемер по окну из старших 128 битов: окно не ниже s - 64, тогда новые
+// a, b >= 2^s. Если он не может сделать шаг (числа сильно разной длины или
+// разность уже мала) - одно вычитание и одно деление. Возвращает false,
+// если |a - b| < 2^s и шагать некуда (при s = 0 это a == b)
+bool BigInteger::gcdStep(BigInteger& a, BigInteger& b, size_t s, GcdMatrix* m) {
+    BI_STATS_SCOPE(Lehmer, std::max(a.limbs_.size(), b.limbs_.size()));
+    const size_t n = maxBits(a, b);
+    size_t p = n > 128 ? n - 128 : 0;
+    if (s > 64)
+        p = std::max(p, s - 64);
+
+    Matrix2 q;
+    if (lehmer(window(a, p), window(b, p), q)) {
+        // a' = m11 a - m01 b, b' = m00 b - m10 a, обе разности неотрицательны и не больше a, b
+        const size_t len = std::max(a.limbs_.size(), b.limbs_.size());
+        a.limbs_.resize(len, 0);
+        b.limbs_.resize(len, 0);
+        bi_limb_t* ap = a.limbs_.data();
+        bi_limb_t* bp = b.limbs_.data();
+
+        scratch::Frame frame;
+        bi_limb_t* t = frame.alloc(len);
+        mpn::mul_1(t, ap, len, q.m11);
+        mpn::submul_1(t, bp, len, q.m01);
+        mpn::mul_1(bp, bp, len, q.m00);
+        mpn::submul_1(bp, ap, len, q.m10);
+        std::copy(t, t + len, ap);
+        a.normalize();
+        b.normalize();
+        if (m)
+            m->mul(q);
+        return true;
+    }
+
+    const bool first = cmpAbs(a, b) >= 0;
+    BigInteger& x = first ? a : b;
+    BigInteger& y = first ? b : a;
+    BigInteger d = x - y;
+    if (d.bitLength() <= s)
+        return false;
+    x = std::move(d);
+    if (m)
+        m->subtracted(first, BigInteger(1));
+
+    // Теперь делим большее на меньшее, остаток оставляем не меньше 2^s
+    const bool second = cmpAbs(x, y) >= 0;
+    BigInteger& big = second ? x : y;
+    const BigInteger& small = second ? y : x;
+    auto [quotient, remainder] = divMod(big, small);
+    if (remainder.bitLength() <= s) {
+        quotient -= BigInteger(1);
+        remainder += small;
+    }
+    if (!quotient.isZero()) {
+        big = std::move(remainder);
+        if (m)
+            m->subtracted(first == second, quotient);
+    }
+    return true;
+}
+
+// Приводит (a, b) пока |a - b| >= 2^s, s = n/2 + 1 (n - длина большего в битах),
+// оставляя a, b >= 2^s. Матрица шагов домножается справа к m.
+// Схема как у mpn_hgcd из GMP: старшая половина битов рекурсивно, досчёт
+// шагами до 3n/4, ещё одна рекурсия по старшим битам остатка, и шаги Лемера
+bool BigInteger::hgcd(BigInteger& a, BigInteger& b, GcdMatrix& m) {
+    BI_STATS_SCOPE(HalfGcd, std::max(a.limbs_.size(), b.limbs_.size()));
+    const size_t n = maxBits(a, b);
+    const size_t s = n / 2 + 1;
+    if (a.bitLength() <= s || b.bitLength() <= s)
+        return false;
+
+    bool progress = false;
+    if (n > HGCD_THRESHOLD * 64) {
+        progress = hgcdReduce(a, b, n / 2, &m);
+
+        const size_t n2 = 3 * n / 4 + 1;
+        while (maxBits(a, b) > n2) {
+            if (!gcdStep(a, b, s, &m))
+                return progress;
+            progress = true;
+        }
+
+        const size_t nn = maxBits(a, b);
+        if (nn > s + 128 && hgcdReduce(a, b, 2 * s - nn + 1, &m))
+            progress = true;
+    }
+
+    while (gcdStep(a, b, s, &m))
+        progress = true;
+    return progress;
+}
+
+// hgcd для старших битов (a >> p, b >> p). Полученная матрица R годится и для
+// полных чисел: a' = (a >> p)' 2^p + (m11 a_low - m01 b_low), аналогично b'.
+// Если m не пустой, R домножается к нему справа
+bool BigInteger::hgcdReduce(BigInteger& a, BigInteger& b, size_t p, GcdMatrix* m) {
+    BigInteger ah, al, bh, bl;
+    splitBits(a, p, ah, al);
+    splitBits(b, p, bh, bl);
+
+    GcdMatrix r;
+    if (!hgcd(ah, bh, r))
+        return false;
+
+    a = (ah << p) + (r.m11 * al - r.m01 * bl);
+    b = (bh << p) + (r.m00 * bl - r.m10 * al);
+    if (m)
+        m->mul(r);
+    return true;
+}
+
+BigInteger BigInteger::gcd(const BigInteger& x, const BigInteger& y) {
+    BigInteger a = x, b = y;
+    a.negative_ = b.negative_ = false;
+    if (a.isZero()) return b;
+    if (b.isZero()) return a;
+
+    // Длинные числа: half-GCD по старшим 2/3 битов сокращает пару примерно на треть
+    while (std::max(a.limbs_.size(), b.limbs_.size()) >= HGCD_THRESHOLD) {
+        if (!hgcdReduce(a, b, maxBits(a, b) / 3, nullptr) && !gcdStep(a, b, 0, nullptr))
+            return a;
+    }
+    while (maxBits(a, b) > 128) {
+        if (!gcdStep(a, b, 0, nullptr))
+            return a;
+    }
+
+    u128 g = binaryGcd(window(a, 0), window(b, 0));
+    BigInteger res;
+    res.limbs_.assign(2, 0);
+    res.limbs_[0] = static_cast<bi_limb_t>(g);
+    res.limbs_[1] = static_cast<bi_limb_t>(g >> 64);
+    res.normalize();
+    return res;
+}
+
+std::tuple<BigInteger, BigInteger, BigInteger> BigInteger::extendedGCD(const BigInteger& x, const BigInteger& y) {
+    const BigInteger sx(x.negative_ ? -1 : 1), sy(y.negative_ ? -1 : 1);
+    BigInteger a = x, b = y;
+    a.negative_ = b.negative_ = false;
+    if (b.isZero())
+        return {a, a.isZero() ? BigInteger(1) : sx, BigInteger(0)};
+    if (a.isZero())
+        return {b, BigInteger(0), sy};
+
+    // Те же шаги, что в gcd, но с накоплением матрицы: (|x|, |y|) = M (a, b)
+    GcdMatrix m;
+    m.rowOnly = true;
+    for (;;) {
+        if (std::max(a.limbs_.size(), b.limbs_.size()) >= HGCD_THRESHOLD
+            && hgcdReduce(a, b, maxBits(a, b) / 3, &m))
+            continue;
+        if (!gcdStep(a, b, 0, &m))
+            break;
+    }
+
+    // Остались a = b = g. После a -= b пара (0, g) и g = -m10 |x| + m00 |y|
+    m.subtracted(true, BigInteger(1));
+    BigInteger g = std::move(b);
+    BigInteger u = BigInteger(0) - m.m10;
+
+    // Берём коэффициент с |u| <= |y| / 2g, второй досчитываем точным делением
+    BigInteger ax = x, ay = y;
+    ax.negative_ = ay.negative_ = false;
+    BigInteger period = ay / g;
+    u %= period;
+    if (u.negative_)
+        u += period;
+    if (u + u > period)
+        u -= period;
+    BigInteger v = fusedProduct(g, ax, u, true) / ay;
+
+    return {g, u * sx, v * sy};
+}
+
+BigInteger BigInteger::modInverse(const BigInteger& mod) const {
+    if (mod.negative_ || mod.isZero())
+        throw std::invalid_argument("modInverse: modulus must be positive");
+
+    BigInteger r = *this % mod;
+    if (r.negative_)
+        r += mod;
+    auto [g, u, v] = extendedGCD(r, mod);
+    if (!(g == BigInteger(1)))
+        throw std::runtime_error("modInverse: value is not invertible");
+
+    u %= mod;
+    if (u.negative_)
+        u += mod;
+    return u;
+}
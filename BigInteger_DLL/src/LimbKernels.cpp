@@ -0,0 +1,239 @@
+#include "LimbKernels.h"
+
+// Ядра на ассемблере x86-64 и их выбор при старте.
+// add_n/sub_n - цепочка adc/sbb по четыре лимба без ветвлений на переносе.
+// mul_1/addmul_1/submul_1 - mulx (не трогает флаги) и две независимые цепочки
+// переносов: adcx складывает младшую половину произведения со старшей
+// предыдущей через CF, adox добавляет результат к rp через OF (как в GMP для
+// Broadwell и новее). Счётчик цикла меняем через lea/jrcxz, они флаги не портят.
+
+namespace mpn {
+
+constinit KernelTable kernels = {
+    generic::add_n, generic::sub_n, generic::mul_1, generic::addmul_1, generic::submul_1,
+};
+
+#if defined(__x86_64__) && defined(__GNUC__)
+
+namespace {
+
+limb_t add_n_adx(limb_t* rp, const limb_t* ap, const limb_t* bp, size_t n) {
+    size_t rest = n & 3;
+    size_t quads = n >> 2;
+    limb_t carry;
+    asm volatile(
+        "xor %%eax, %%eax\n\t"          // CF = 0
+        "test %[rest], %[rest]\n\t"
+        "jz 2f\n"
+        "1:\n\t"
+        "mov (%[ap]), %%r8\n\t"
+        "adc (%[bp]), %%r8\n\t"
+        "mov %%r8, (%[rp])\n\t"
+        "lea 8(%[ap]), %[ap]\n\t"
+        "lea 8(%[bp]), %[bp]\n\t"
+        "lea 8(%[rp]), %[rp]\n\t"
+        "dec %[rest]\n\t"
+        "jnz 1b\n"
+        "2:\n\t"
+        "jrcxz 4f\n"
+        "3:\n\t"
+        "mov (%[ap]), %%r8\n\t"
+        "mov 8(%[ap]), %%r9\n\t"
+        "mov 16(%[ap]), %%r10\n\t"
+        "mov 24(%[ap]), %%r11\n\t"
+        "adc (%[bp]), %%r8\n\t"
+        "adc 8(%[bp]), %%r9\n\t"
+        "adc 16(%[bp]), %%r10\n\t"
+        "adc 24(%[bp]), %%r11\n\t"
+        "mov %%r8, (%[rp])\n\t"
+        "mov %%r9, 8(%[rp])\n\t"
+        "mov %%r10, 16(%[rp])\n\t"
+        "mov %%r11, 24(%[rp])\n\t"
+        "lea 32(%[ap]), %[ap]\n\t"
+        "lea 32(%[bp]), %[bp]\n\t"
+        "lea 32(%[rp]), %[rp]\n\t"
+        "dec %%rcx\n\t"
+        "jnz 3b\n"
+        "4:\n\t"
+        "setc %%al\n\t"
+        : [rp] "+r"(rp), [ap] "+r"(ap), [bp] "+r"(bp), [rest] "+r"(rest), "+c"(quads), "=&a"(carry)
+        :
+        : "r8", "r9", "r10", "r11", "cc", "memory");
+    return carry;
+}
+
+limb_t sub_n_adx(limb_t* rp, const limb_t* ap, const limb_t* bp, size_t n) {
+    size_t rest = n & 3;
+    size_t quads = n >> 2;
+    limb_t borrow;
+    asm volatile(
+        "xor %%eax, %%eax\n\t"
+        "test %[rest], %[rest]\n\t"
+        "jz 2f\n"
+        "1:\n\t"
+        "mov (%[ap]), %%r8\n\t"
+        "sbb (%[bp]), %%r8\n\t"
+        "mov %%r8, (%[rp])\n\t"
+        "lea 8(%[ap]), %[ap]\n\t"
+        "lea 8(%[bp]), %[bp]\n\t"
+        "lea 8(%[rp]), %[rp]\n\t"
+        "dec %[rest]\n\t"
+        "jnz 1b\n"
+        "2:\n\t"
+        "jrcxz 4f\n"
+        "3:\n\t"
+        "mov (%[ap]), %%r8\n\t"
+        "mov 8(%[ap]), %%r9\n\t"
+        "mov 16(%[ap]), %%r10\n\t"
+        "mov 24(%[ap]), %%r11\n\t"
+        "sbb (%[bp]), %%r8\n\t"
+        "sbb 8(%[bp]), %%r9\n\t"
+        "sbb 16(%[bp]), %%r10\n\t"
+        "sbb 24(%[bp]), %%r11\n\t"
+        "mov %%r8, (%[rp])\n\t"
+        "mov %%r9, 8(%[rp])\n\t"
+        "mov %%r10, 16(%[rp])\n\t"
+        "mov %%r11, 24(%[rp])\n\t"
+        "lea 32(%[ap]), %[ap]\n\t"
+        "lea 32(%[bp]), %[bp]\n\t"
+        "lea 32(%[rp]), %[rp]\n\t"
+        "dec %%rcx\n\t"
+        "jnz 3b\n"
+        "4:\n\t"
+        "setc %%al\n\t"
+        : [rp] "+r"(rp), [ap] "+r"(ap), [bp] "+r"(bp), [rest] "+r"(rest), "+c"(quads), "=&a"(borrow)
+        :
+        : "r8", "r9", "r10", "r11", "cc", "memory");
+    return borrow;
+}
+
+// Одна цепочка: lo_i + hi_{i-1} + CF, старшая часть произведения не больше B - 2,
+// так что перенос в неё не переполняется
+limb_t mul_1_adx(limb_t* rp, const limb_t* ap, size_t n, limb_t b, limb_t carry) {
+    asm volatile(
+        "xor %%r11d, %%r11d\n\t"        // CF = OF = 0
+        "1:\n\t"
+        "mulx (%[ap]), %%r8, %%r10\n\t"
+        "adcx %[carry], %%r8\n\t"
+        "mov %%r8, (%[rp])\n\t"
+        "mov %%r10, %[carry]\n\t"
+        "lea 8(%[ap]), %[ap]\n\t"
+        "lea 8(%[rp]), %[rp]\n\t"
+        "lea -1(%%rcx), %%rcx\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n"
+        "2:\n\t"
+        "adcx %%r11, %[carry]\n\t"
+        : [rp] "+r"(rp), [ap] "+r"(ap), "+c"(n), [carry] "+r"(carry)
+        : "d"(b)
+        : "r8", "r10", "r11", "cc", "memory");
+    return carry;
+}
+
+// t_i = lo_i + hi_{i-1} по цепочке CF, rp_i + t_i по цепочке OF.
+// Тело развёрнуто на два лимба, нечётный первый делаем отдельно
+limb_t addmul_1_adx(limb_t* rp, const limb_t* ap, size_t n, limb_t b) {
+    limb_t hi = 0;
+    size_t pairs = n >> 1;
+    asm volatile(
+        "xor %%r11d, %%r11d\n\t"        // CF = OF = 0
+        "test $1, %[n]\n\t"
+        "jz 1f\n\t"
+        "mulx (%[ap]), %%r8, %%r10\n\t"
+        "adox (%[rp]), %%r8\n\t"
+        "mov %%r8, (%[rp])\n\t"
+        "mov %%r10, %[hi]\n\t"
+        "lea 8(%[ap]), %[ap]\n\t"
+        "lea 8(%[rp]), %[rp]\n"
+        "1:\n\t"
+        "jrcxz 3f\n"
+        "2:\n\t"
+        "mulx (%[ap]), %%r8, %%r10\n\t"
+        "mulx 8(%[ap]), %%r9, %[n]\n\t"
+        "adcx %[hi], %%r8\n\t"
+        "adox (%[rp]), %%r8\n\t"
+        "adcx %%r10, %%r9\n\t"
+        "adox 8(%[rp]), %%r9\n\t"
+        "mov %%r8, (%[rp])\n\t"
+        "mov %%r9, 8(%[rp])\n\t"
+        "mov %[n], %[hi]\n\t"
+        "lea 16(%[ap]), %[ap]\n\t"
+        "lea 16(%[rp]), %[rp]\n\t"
+        "lea -1(%%rcx), %%rcx\n\t"
+        "jrcxz 3f\n\t"
+        "jmp 2b\n"
+        "3:\n\t"
+        "adcx %%r11, %[hi]\n\t"
+        "adox %%r11, %[hi]\n\t"
+        : [rp] "+r"(rp), [ap] "+r"(ap), [n] "+r"(n), "+c"(pairs), [hi] "+r"(hi)
+        : "d"(b)
+        : "r8", "r9", "r10", "r11", "cc", "memory");
+    return hi;
+}
+
+// rp - t = rp + ~t + 1 (mod B^n): вычитание через adox с инвертированным t и
+// начальным OF = 1. Заём на выходе - старшая часть t плюс 1 - OF
+limb_t submul_1_adx(limb_t* rp, const limb_t* ap, size_t n, limb_t b) {
+    limb_t hi = 0;
+    limb_t of;
+    size_t pairs = n >> 1;
+    asm volatile(
+        "xor %%r11d, %%r11d\n\t"
+        "mov $0x7fffffffffffffff, %%r8\n\t"
+        "test $1, %[n]\n\t"             // test сбрасывает OF, ставим его после
+        "jz 0f\n\t"
+        "add $1, %%r8\n\t"              // OF = 1, CF = 0
+        "mulx (%[ap]), %%r8, %%r10\n\t"
+        "not %%r8\n\t"
+        "adox (%[rp]), %%r8\n\t"
+        "mov %%r8, (%[rp])\n\t"
+        "mov %%r10, %[hi]\n\t"
+        "lea 8(%[ap]), %[ap]\n\t"
+        "lea 8(%[rp]), %[rp]\n\t"
+        "jmp 1f\n"
+        "0:\n\t"
+        "add $1, %%r8\n"
+        "1:\n\t"
+        "jrcxz 3f\n"
+        "2:\n\t"
+        "mulx (%[ap]), %%r8, %%r10\n\t"
+        "mulx 8(%[ap]), %%r9, %[n]\n\t"
+        "adcx %[hi], %%r8\n\t"
+        "not %%r8\n\t"
+        "adox (%[rp]), %%r8\n\t"
+        "adcx %%r10, %%r9\n\t"
+        "not %%r9\n\t"
+        "adox 8(%[rp]), %%r9\n\t"
+        "mov %%r8, (%[rp])\n\t"
+        "mov %%r9, 8(%[rp])\n\t"
+        "mov %[n], %[hi]\n\t"
+        "lea 16(%[ap]), %[ap]\n\t"
+        "lea 16(%[rp]), %[rp]\n\t"
+        "lea -1(%%rcx), %%rcx\n\t"
+        "jrcxz 3f\n\t"
+        "jmp 2b\n"
+        "3:\n\t"
+        "adcx %%r11, %[hi]\n\t"
+        "adox %%r11, %%r11\n\t"         // r11 = OF
+        "mov %%r11, %[of]\n\t"
+        : [rp] "+r"(rp), [ap] "+r"(ap), [n] "+r"(n), "+c"(pairs), [hi] "+r"(hi), [of] "=r"(of)
+        : "d"(b)
+        : "r8", "r9", "r10", "r11", "cc", "memory");
+    return hi + 1 - of;
+}
+
+// Выбираем ядра до main, если процессор умеет ADX и BMI2 (mulx)
+struct Dispatch {
+    Dispatch() {
+        __builtin_cpu_init();
+        if (!__builtin_cpu_supports("adx") || !__builtin_cpu_supports("bmi2"))
+            return;
+        kernels = {add_n_adx, sub_n_adx, mul_1_adx, addmul_1_adx, submul_1_adx};
+    }
+} dispatch;
+
+} // namespace
+
+#endif
+
+} // namespace mpn
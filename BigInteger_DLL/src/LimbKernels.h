@@ -0,0 +1,317 @@
+#pragma once
+
+#include "../include/BigInteger.h"
+
+// Низкоуровневые операции над массивами лимбов (в духе mpn_* из GMP).
+// Числа хранятся от младшего лимба к старшему, длины задаются явно,
+// результат может совпадать с одним из аргументов (rp == ap).
+namespace mpn {
+
+using limb_t = BigInteger::bi_limb_t;
+using dlimb_t = unsigned __int128;
+
+constexpr unsigned LIMB_BITS = 64;
+
+// Переносимые версии основных ядер. На x86-64 с ADX/BMI2 их заменяют
+// ассемблерные (LimbKernels.cpp), выбор один раз при старте по CPUID
+namespace generic {
+
+// rp = ap + bp, возвращает перенос
+inline limb_t add_n(limb_t* rp, const limb_t* ap, const limb_t* bp, size_t n) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dlimb_t sum = (dlimb_t)ap[i] + bp[i] + carry;
+        rp[i] = static_cast<limb_t>(sum);
+        carry = static_cast<limb_t>(sum >> LIMB_BITS);
+    }
+    return carry;
+}
+
+// rp = ap - bp, возвращает заём
+inline limb_t sub_n(limb_t* rp, const limb_t* ap, const limb_t* bp, size_t n) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        limb_t a = ap[i], b = bp[i];
+        limb_t d = a - b;
+        limb_t b1 = a < b;
+        rp[i] = d - borrow;
+        borrow = b1 | (d < borrow);
+    }
+    return borrow;
+}
+
+// rp = ap * b + carry, возвращает старший лимб
+inline limb_t mul_1(limb_t* rp, const limb_t* ap, size_t n, limb_t b, limb_t carry) {
+    for (size_t i = 0; i < n; ++i) {
+        dlimb_t cur = (dlimb_t)ap[i] * b + carry;
+        rp[i] = static_cast<limb_t>(cur);
+        carry = static_cast<limb_t>(cur >> LIMB_BITS);
+    }
+    return carry;
+}
+
+// rp += ap * b, возвращает перенос
+inline limb_t addmul_1(limb_t* rp, const limb_t* ap, size_t n, limb_t b) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dlimb_t cur = (dlimb_t)ap[i] * b + rp[i] + carry;
+        rp[i] = static_cast<limb_t>(cur);
+        carry = static_cast<limb_t>(cur >> LIMB_BITS);
+    }
+    return carry;
+}
+
+// rp -= ap * b, возвращает заём
+inline limb_t submul_1(limb_t* rp, const limb_t* ap, size_t n, limb_t b) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dlimb_t prod = (dlimb_t)ap[i] * b + borrow;
+        limb_t lo = static_cast<limb_t>(prod);
+        limb_t r = rp[i];
+        rp[i] = r - lo;
+        borrow = static_cast<limb_t>(prod >> LIMB_BITS) + (r < lo);
+    }
+    return borrow;
+}
+
+} // namespace generic
+
+struct KernelTable {
+    limb_t (*add_n)(limb_t* rp, const limb_t* ap, const limb_t* bp, size_t n);
+    limb_t (*sub_n)(limb_t* rp, const limb_t* ap, const limb_t* bp, size_t n);
+    limb_t (*mul_1)(limb_t* rp, const limb_t* ap, size_t n, limb_t b, limb_t carry);
+    limb_t (*addmul_1)(limb_t* rp, const limb_t* ap, size_t n, limb_t b);
+    limb_t (*submul_1)(limb_t* rp, const limb_t* ap, size_t n, limb_t b);
+};
+
+// До выбора (и без ADX) - переносимые версии, так что годится и в статических конструкторах
+extern KernelTable kernels;
+
+// Совсем короткие массивы дешевле сделать на месте, чем звать ядро по указателю
+constexpr size_t DISPATCH_MIN = 4;
+
+// rp = ap + bp, возвращает перенос
+inline limb_t add_n(limb_t* rp, const limb_t* ap, const limb_t* bp, size_t n) {
+    return n < DISPATCH_MIN ? generic::add_n(rp, ap, bp, n) : kernels.add_n(rp, ap, bp, n);
+}
+
+// rp = ap - bp, возвращает заём
+inline limb_t sub_n(limb_t* rp, const limb_t* ap, const limb_t* bp, size_t n) {
+    return n < DISPATCH_MIN ? generic::sub_n(rp, ap, bp, n) : kernels.sub_n(rp, ap, bp, n);
+}
+
+// rp = ap * b + carry, возвращает старший лимб
+inline limb_t mul_1(limb_t* rp, const limb_t* ap, size_t n, limb_t b, limb_t carry = 0) {
+    return n < DISPATCH_MIN ? generic::mul_1(rp, ap, n, b, carry) : kernels.mul_1(rp, ap, n, b, carry);
+}
+
+// rp += ap * b, возвращает перенос
+inline limb_t addmul_1(limb_t* rp, const limb_t* ap, size_t n, limb_t b) {
+    return n < DISPATCH_MIN ? generic::addmul_1(rp, ap, n, b) : kernels.addmul_1(rp, ap, n, b);
+}
+
+// rp -= ap * b, возвращает заём
+inline limb_t submul_1(limb_t* rp, const limb_t* ap, size_t n, limb_t b) {
+    return n < DISPATCH_MIN ? generic::submul_1(rp, ap, n, b) : kernels.submul_1(rp, ap, n, b);
+}
+
+// rp = ap + b (b - один лимб), возвращает перенос. Как только перенос
+// кончился, остаток просто копируем (на месте - сразу выходим)
+inline limb_t add_1(limb_t* rp, const limb_t* ap, size_t n, limb_t b) {
+    for (size_t i = 0; i < n; ++i) {
+        limb_t s = ap[i] + b;
+        b = s < b;
+        rp[i] = s;
+        if (!b) {
+            if (rp != ap)
+                std::copy(ap + i + 1, ap + n, rp + i + 1);
+            return 0;
+        }
+    }
+    return b;
+}
+
+// rp = ap - b, возвращает заём
+inline limb_t sub_1(limb_t* rp, const limb_t* ap, size_t n, limb_t b) {
+    for (size_t i = 0; i < n; ++i) {
+        limb_t a = ap[i];
+        rp[i] = a - b;
+        b = a < b;
+        if (!b) {
+            if (rp != ap)
+                std::copy(ap + i + 1, ap + n, rp + i + 1);
+            return 0;
+        }
+    }
+    return b;
+}
+
+// rp = ap + bp для длин an >= bn, возвращает перенос
+inline limb_t add(limb_t* rp, const limb_t* ap, size_t an, const limb_t* bp, size_t bn) {
+    limb_t carry = add_n(rp, ap, bp, bn);
+    return add_1(rp + bn, ap + bn, an - bn, carry);
+}
+
+// rp = ap - bp для длин an >= bn, возвращает заём
+inline limb_t sub(limb_t* rp, const limb_t* ap, size_t an, const limb_t* bp, size_t bn) {
+    limb_t borrow = sub_n(rp, ap, bp, bn);
+    return sub_1(rp + bn, ap + bn, an - bn, borrow);
+}
+
+// rp = ap << cnt, 0 < cnt < 64, возвращает выдвинутые старшие биты
+inline limb_t lshift(limb_t* rp, const limb_t* ap, size_t n, unsigned cnt) {
+    limb_t out = ap[n - 1] >> (LIMB_BITS - cnt);
+    for (size_t i = n - 1; i > 0; --i)
+        rp[i] = (ap[i] << cnt) | (ap[i - 1] >> (LIMB_BITS - cnt));
+    rp[0] = ap[0] << cnt;
+    return out;
+}
+
+// rp = ap >> cnt, 0 < cnt < 64, возвращает выдвинутые младшие биты (в старших разрядах)
+inline limb_t rshift(limb_t* rp, const limb_t* ap, size_t n, unsigned cnt) {
+    limb_t out = ap[0] << (LIMB_BITS - cnt);
+    for (size_t i = 0; i + 1 < n; ++i)
+        rp[i] = (ap[i] >> cnt) | (ap[i + 1] << (LIMB_BITS - cnt));
+    rp[n - 1] = ap[n - 1] >> cnt;
+    return out;
+}
+
+// Побитовые операции: простые циклы без переносов, компилятор их векторизует
+inline void and_n(limb_t* rp, const limb_t* ap, const limb_t* bp, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        rp[i] = ap[i] & bp[i];
+}
+
+inline void ior_n(limb_t* rp, const limb_t* ap, const limb_t* bp, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        rp[i] = ap[i] | bp[i];
+}
+
+inline void xor_n(limb_t* rp, const limb_t* ap, const limb_t* bp, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        rp[i] = ap[i] ^ bp[i];
+}
+
+inline void com(limb_t* rp, const limb_t* ap, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        rp[i] = ~ap[i];
+}
+
+// rp = -ap mod B^n (дополнительный код): нули снизу остаются, первый ненулевой
+// лимб меняет знак, выше - инверсия. Возвращает 1, если ap != 0
+inline limb_t neg(limb_t* rp, const limb_t* ap, size_t n) {
+    size_t i = 0;
+    for (; i < n && ap[i] == 0; ++i)
+        rp[i] = 0;
+    if (i == n)
+        return 0;
+    rp[i] = 0 - ap[i];
+    com(rp + i + 1, ap + i + 1, n - i - 1);
+    return 1;
+}
+
+inline size_t popcount(const limb_t* ap, size_t n) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i)
+        count += __builtin_popcountll(ap[i]);
+    return count;
+}
+
+inline int cmp(const limb_t* ap, const limb_t* bp, size_t n) {
+    for (size_t i = n; i-- > 0;) {
+        if (ap[i] != bp[i])
+            return ap[i] < bp[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// Обратный к нормализованному d (старший бит = 1): floor((B^2 - 1) / d) - B
+inline limb_t invert_limb(limb_t d) {
+    return static_cast<limb_t>((((dlimb_t)~d << LIMB_BITS) | ~limb_t(0)) / d);
+}
+
+// Деление (u1, u0) на нормализованный d при u1 < d через заранее
+// посчитанный обратный (Möller, Granlund, "Improved division by invariant
+// integers", алгоритм 4). Возвращает частное, остаток кладёт в r.
+inline limb_t div2by1(limb_t& r, limb_t u1, limb_t u0, limb_t d, limb_t dinv) {
+    dlimb_t q = (dlimb_t)dinv * u1 + (((dlimb_t)u1 << LIMB_BITS) | u0);
+    limb_t q1 = static_cast<limb_t>(q >> LIMB_BITS) + 1;
+    limb_t q0 = static_cast<limb_t>(q);
+    limb_t rem = u0 - q1 * d;
+    if (rem > q0) {
+        --q1;
+        rem += d;
+    }
+    if (rem >= d) {
+        ++q1;
+        rem -= d;
+    }
+    r = rem;
+    return q1;
+}
+
+// qp = ap / d для произвольного d != 0, возвращает остаток. Делимое сдвигаем
+// на лету так же, как нормализованный делитель, и делим через обратный.
+inline limb_t divrem_1(limb_t* qp, const limb_t* ap, size_t n, limb_t d) {
+    const unsigned shift = __builtin_clzll(d);
+    const limb_t dn = d << shift;
+    const limb_t dinv = invert_limb(dn);
+
+    limb_t r = 0;
+    if (shift == 0) {
+        for (size_t i = n; i-- > 0;)
+            qp[i] = div2by1(r, r, ap[i], dn, dinv);
+        return r;
+    }
+
+    r = ap[n - 1] >> (LIMB_BITS - shift);
+    for (size_t i = n; i-- > 0;) {
+        limb_t u0 = ap[i] << shift;
+        if (i > 0)
+            u0 |= ap[i - 1] >> (LIMB_BITS - shift);
+        qp[i] = div2by1(r, r, u0, dn, dinv);
+    }
+    return r >> shift;
+}
+
+// ap mod d без частного, тот же сдвиг и обратный, что в divrem_1
+inline limb_t mod_1(const limb_t* ap, size_t n, limb_t d) {
+    const unsigned shift = __builtin_clzll(d);
+    const limb_t dn = d << shift;
+    const limb_t dinv = invert_limb(dn);
+
+    limb_t r = 0;
+    if (shift == 0) {
+        for (size_t i = n; i-- > 0;)
+            div2by1(r, r, ap[i], dn, dinv);
+        return r;
+    }
+
+    r = ap[n - 1] >> (LIMB_BITS - shift);
+    for (size_t i = n; i-- > 0;) {
+        limb_t u0 = ap[i] << shift;
+        if (i > 0)
+            u0 |= ap[i - 1] >> (LIMB_BITS - shift);
+        div2by1(r, r, u0, dn, dinv);
+    }
+    return r >> shift;
+}
+
+// rp = ap / d для нечётного d, когда деление точное. Делим снизу вверх (Хенсель)
+// по модулю B^n, так что годится и для отрицательных в дополнительном коде.
+inline void divexact_1(limb_t* rp, const limb_t* ap, size_t n, limb_t d) {
+    limb_t dinv = d;                    // d^{-1} mod 2^64, Ньютон удваивает верные биты
+    for (int i = 0; i < 5; ++i)
+        dinv *= 2 - d * dinv;
+
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        limb_t s = ap[i];
+        limb_t q = (s - borrow) * dinv;
+        limb_t c = s < borrow;
+        rp[i] = q;
+        borrow = static_cast<limb_t>(((dlimb_t)q * d) >> LIMB_BITS) + c;
+    }
+}
+
+} // namespace mpn
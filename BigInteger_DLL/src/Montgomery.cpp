@@ -0,0 +1,264 @@
+#include "../include/MontgomeryContext.h"
+#include "LimbKernels.h"
+#include "Scratch.h"
+#include "Stats.h"
+
+// Арифметика по фиксированному модулю без деления в цикле.
+// Монтгомери (нечётный m, R = B^n): храним x * R mod m, после умножения
+// REDC(t) = t * R^{-1} mod m прибавляет к t кратное m, чтобы младшие n лимбов
+// обнулились, и просто отбрасывает их.
+// Барретт (чётный m): частное t / m оцениваем умножением на заранее
+// посчитанное mu = floor(B^{2n} / m), ошибка оценки не больше 2.
+
+namespace {
+
+using limb_t = MontgomeryContext::limb_t;
+
+// rp[0, n) = |x|, старшие лимбы - нули
+void copyPadded(limb_t* rp, size_t n, const BigInteger& x) {
+    auto limbs = x.get_limbs();
+    std::copy(limbs.begin(), limbs.end(), rp);
+    std::fill(rp + limbs.size(), rp + n, 0);
+}
+
+// Ширина окна по длине показателя в битах (как в OpenSSL)
+unsigned windowBits(size_t bits) {
+    if (bits > 671) return 6;
+    if (bits > 239) return 5;
+    if (bits > 79) return 4;
+    if (bits > 23) return 3;
+    return 1;
+}
+
+} // namespace
+
+MontgomeryContext::MontgomeryContext(const BigInteger& modulus)
+    : modulus_(modulus), n_(modulus.limbs_.size()), montgomery_(modulus.limbs_[0] & 1) {
+    if (modulus.negative_ || modulus.isZero())
+        throw std::invalid_argument("modulus must be positive");
+
+    const size_t n = n_;
+    const limb_t* mp = modulus_.limbs_.data();
+    BigInteger base;                    // B^n
+    base.limbs_.assign(n + 1, 0);
+    base.limbs_[n] = 1;
+
+    one_.resize(n);
+    if (!montgomery_) {
+        // mu = floor(B^{2n} / m), при m = B^{n-1} это n + 2 лимба
+        BigInteger b2n = base * base;
+        BigInteger mu = b2n / modulus_;
+        mu_.assign(mu.limbs_.begin(), mu.limbs_.end());
+        std::fill(one_.begin(), one_.end(), 0);
+        one_[0] = 1;
+        return;
+    }
+
+    // m^{-1} mod 2^64 методом Ньютона, каждая итерация удваивает число верных бит
+    limb_t inv = mp[0];
+    for (int i = 0; i < 5; ++i)
+        inv *= 2 - mp[0] * inv;
+    minv_ = 0 - inv;
+
+    // -m^{-1} mod B^n: подбираем лимбы x так, чтобы m * x + 1 делилось на B^n
+    if (n >= REDC_MUL_THRESHOLD) {
+        std::vector<limb_t> r(n, ~limb_t(0));       // -1 mod B^n
+        minvN_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            minvN_[i] = r[i] * inv;
+            mpn::submul_1(r.data() + i, mp, n - i, minvN_[i]);
+        }
+    }
+
+    BigInteger r = base % modulus_;                 // R mod m - единица в форме Монтгомери
+    copyPadded(one_.data(), n, r);
+    r2_.resize(n);
+    copyPadded(r2_.data(), n, (r * r) % modulus_);
+}
+
+// t * R^{-1} mod m для t < m * R
+void MontgomeryContext::redc(limb_t* rp, limb_t* tp) const {
+    BI_STATS_SCOPE(Redc, n_);
+    const size_t n = n_;
+    const limb_t* mp = modulus_.limbs_.data();
+    limb_t carry;
+
+    if (n < REDC_MUL_THRESHOLD) {
+        // По лимбу: q = t_i * minv обнуляет t_i. Перенос строки кладём на место
+        // обнулённого t_i и добавляем все переносы разом в конце
+        for (size_t i = 0; i < n; ++i) {
+            limb_t q = tp[i] * minv_;
+            tp[i] = mpn::addmul_1(tp + i, mp, n, q);
+        }
+        carry = mpn::add_n(rp, tp + n, tp, n);
+    } else {
+        // Сразу всё: q = (t mod R) * (-m^{-1}) mod R, t + q * m делится на R
+        limb_t* q = tp + 2 * n;
+        limb_t* qm = tp + 4 * n;
+        BigInteger::mulLimbs(q, tp, n, minvN_.data(), n);
+        BigInteger::mulLimbs(qm, q, n, mp, n);
+        carry = mpn::add_n(tp, tp, qm, 2 * n);
+        std::copy(tp + n, tp + 2 * n, rp);
+    }
+
+    // Результат меньше 2m
+    if (carry || mpn::cmp(rp, mp, n) >= 0)
+        mpn::sub_n(rp, rp, mp, n);
+}
+
+// t mod m для t < B^{2n} (HAC, алгоритм 14.42)
+void MontgomeryContext::barrett(limb_t* rp, limb_t* tp) const {
+    BI_STATS_SCOPE(Barrett, n_);
+    const size_t n = n_;
+    const size_t mun = mu_.size();
+    const limb_t* mp = modulus_.limbs_.data();
+
+    // q = floor(floor(t / B^{n-1}) * mu / B^{n+1}) < B^{n+1}, занижено не больше чем на 2
+    limb_t* q2 = tp + 2 * n;
+    BigInteger::mulLimbs(q2, tp + n - 1, n + 1, mu_.data(), mun);
+    const limb_t* q = q2 + n + 1;
+
+    // r = t - q * m считаем по модулю B^{n+1}, настоящий r < 3m влезает
+    limb_t* qm = q2 + n + 1 + mun;
+    BigInteger::mulLimbs(qm, q, n + 1, mp, n);
+    mpn::sub_n(tp, tp, qm, n + 1);
+    while (tp[n] || mpn::cmp(tp, mp, n) >= 0)
+        tp[n] -= mpn::sub_n(tp, tp, mp, n);
+    std::copy(tp, tp + n, rp);
+}
+
+void MontgomeryContext::reduce(limb_t* rp, limb_t* tp) const {
+    if (montgomery_)
+        redc(rp, tp);
+    else
+        barrett(rp, tp);
+}
+
+// rp = a * b в представлении, rp может совпадать с ap или bp
+void MontgomeryContext::mul(limb_t* rp, const limb_t* ap, const limb_t* bp, limb_t* tp) const {
+    BigInteger::mulLimbs(tp, ap, n_, bp, n_);
+    reduce(rp, tp);
+}
+
+void MontgomeryContext::load(limb_t* rp, const BigInteger& x) const {
+    if (!x.negative_ && BigInteger::cmpAbs(x, modulus_) < 0) {
+        copyPadded(rp, n_, x);
+        return;
+    }
+    BigInteger r = x % modulus_;        // знак как у x
+    if (r.negative_)
+        r += modulus_;
+    copyPadded(rp, n_, r);
+}
+
+void MontgomeryContext::toDomain(limb_t* rp, const limb_t* xp, limb_t* tp) const {
+    if (montgomery_)
+        mul(rp, xp, r2_.data(), tp);    // x * R^2 * R^{-1}
+    else
+        std::copy(xp, xp + n_, rp);
+}
+
+BigInteger MontgomeryContext::fromLimbs(const limb_t* xp) const {
+    BigInteger res;
+    res.limbs_.assign(xp, xp + n_);
+    res.normalize();
+    return res;
+}
+
+BigInteger MontgomeryContext::fromDomain(const limb_t* xp, limb_t* tp) const {
+    if (!montgomery_)
+        return fromLimbs(xp);
+    std::copy(xp, xp + n_, tp);
+    std::fill(tp + n_, tp + 2 * n_, 0);
+    redc(tp, tp);
+    return fromLimbs(tp);
+}
+
+// Для обычных остатков: REDC(a * b) = a b R^{-1}, второй REDC с R^2 домножает
+// обратно на R. У Барретта представление и есть остаток, там одно умножение
+BigInteger MontgomeryContext::mulmod(const BigInteger& a, const BigInteger& b) const {
+    const size_t n = n_;
+    scratch::Frame frame;
+    limb_t* ap = frame.alloc(n);
+    limb_t* bp = &a == &b ? ap : frame.alloc(n);
+    limb_t* tp = frame.alloc(scratchSize());
+    load(ap, a);
+    if (bp != ap)
+        load(bp, b);
+
+    mul(ap, ap, bp, tp);
+    if (montgomery_)
+        mul(ap, ap, r2_.data(), tp);
+    return fromLimbs(ap);
+}
+
+BigInteger MontgomeryContext::sqrmod(const BigInteger& a) const {
+    return mulmod(a, a);
+}
+
+// Скользящее окно слева направо: нули показателя - только возведения в квадрат,
+// ненулевое окно из не больше k бит (нечётное значение) - одно умножение на
+// заранее посчитанную нечётную степень base^1, base^3, ..., base^{2^k - 1}
+BigInteger MontgomeryContext::modPow(const BigInteger& base, const BigInteger& exp) const {
+    if (exp.negative_)
+        throw std::invalid_argument("modPow: negative exponent");
+
+    const size_t n = n_;
+    const limb_t* ep = exp.limbs_.data();
+    const size_t bits = exp.isZero() ? 0
+        : 64 * exp.limbs_.size() - __builtin_clzll(exp.limbs_.back());
+    auto bit = [&](size_t i) { return (ep[i / 64] >> (i % 64)) & 1; };
+
+    const unsigned k = windowBits(bits);
+    const size_t tableSize = size_t(1) << (k - 1);
+
+    scratch::Frame frame;
+    limb_t* tp = frame.alloc(scratchSize());
+    limb_t* table = frame.alloc(tableSize * n);
+    limb_t* acc = frame.alloc(n);
+
+    load(acc, base);
+    toDomain(table, acc, tp);
+    if (tableSize > 1) {
+        mul(acc, table, table, tp);                 // base^2
+        for (size_t i = 1; i < tableSize; ++i)
+            mul(table + i * n, table + (i - 1) * n, acc, tp);
+    }
+
+    bool started = false;
+    size_t i = bits;
+    while (i > 0) {
+        if (!bit(i - 1)) {
+            mul(acc, acc, acc, tp);
+            --i;
+            continue;
+        }
+
+        // Окно [j, i): не длиннее k бит и заканчивается единицей
+        size_t j = i > k ? i - k : 0;
+        while (!bit(j))
+            ++j;
+        size_t window = 0;
+        for (size_t b = i; b-- > j;)
+            window = window << 1 | bit(b);
+
+        const limb_t* power = table + (window >> 1) * n;
+        if (!started) {
+            std::copy(power, power + n, acc);
+            started = true;
+        } else {
+            for (size_t s = j; s < i; ++s)
+                mul(acc, acc, acc, tp);
+            mul(acc, acc, power, tp);
+        }
+        i = j;
+    }
+
+    if (!started)
+        std::copy(one_.begin(), one_.end(), acc);
+    return fromDomain(acc, tp);
+}
+
+BigInteger BigInteger::modPow(const BigInteger& exp, const BigInteger& mod) const {
+    return MontgomeryContext(mod).modPow(*this, exp);
+}
@@ -0,0 +1,286 @@
+#include "../include/BigInteger.h"
+#include "Parallel.h"
+#include "Stats.h"
+
+// Умножение через number-theoretic transform (NTT) по трём простым модулям.
+// Лимбы берём как коэффициенты многочлена целиком (по 64 бита), считаем
+// свёртку по модулю каждого простого и собираем ответ по китайской теореме
+// об остатках. Коэффициент свёртки не больше min(n, m) * (2^64 - 1)^2 < 2^183,
+// а произведение трёх модулей ~2^184, так что восстановление точное.
+
+namespace {
+
+using u64 = u_int64_t;
+using u128 = unsigned __int128;
+
+// Арифметика по модулю простого p < 2^63 в форме Монтгомери (R = 2^64)
+class MontField {
+public:
+    constexpr MontField(u64 p, u64 g) : p_(p), g_(g), pinv_(p), r2_(0) {
+        // p^{-1} mod 2^64 методом Ньютона, каждая итерация удваивает число верных бит
+        for (int i = 0; i < 6; ++i)
+            pinv_ *= 2 - p_ * pinv_;
+        u64 r = (0 - p_) % p_;              // 2^64 mod p
+        r2_ = static_cast<u64>((u128)r * r % p_);
+    }
+
+    constexpr u64 mod() const { return p_; }
+
+    // t * 2^{-64} mod p, требуется t < p * 2^64
+    constexpr u64 reduce(u128 t) const {
+        u64 m = static_cast<u64>(t) * pinv_;
+        u64 mp = static_cast<u64>(((u128)m * p_) >> 64);
+        u64 th = static_cast<u64>(t >> 64);
+        u64 r = th - mp;
+        return th < mp ? r + p_ : r;
+    }
+
+    constexpr u64 mul(u64 a, u64 b) const { return reduce((u128)a * b); }
+    constexpr u64 add(u64 a, u64 b) const { u64 s = a + b; return s >= p_ ? s - p_ : s; }
+    constexpr u64 sub(u64 a, u64 b) const { return a >= b ? a - b : a + p_ - b; }
+
+    // Переводит любое 64-битное x (не обязательно < p) в форму Монтгомери
+    constexpr u64 toMont(u64 x) const { return mul(x, r2_); }
+    constexpr u64 fromMont(u64 x) const { return reduce(x); }
+
+    constexpr u64 pow(u64 base, u64 exp) const {
+        u64 res = toMont(1);
+        while (exp) {
+            if (exp & 1) res = mul(res, base);
+            base = mul(base, base);
+            exp >>= 1;
+        }
+        return res;
+    }
+
+    // Первообразный корень степени n (n - степень двойки) в форме Монтгомери
+    constexpr u64 rootOfUnity(u64 n) const { return pow(toMont(g_), (p_ - 1) / n); }
+
+private:
+    u64 p_;
+    u64 g_;
+    u64 pinv_;
+    u64 r2_;
+};
+
+// Простые вида c * 2^k + 1, k >= 55, и их первообразные корни
+constexpr MontField NTT_PRIMES[3] = {
+    MontField(4179340454199820289ULL, 3),   // 29 * 2^57 + 1
+    MontField(2485986994308513793ULL, 5),   // 69 * 2^55 + 1
+    MontField(1945555039024054273ULL, 5),   // 27 * 2^56 + 1
+};
+
+constexpr size_t NTT_MAX_LOG = 55;
+constexpr size_t NTT_LEAF = size_t(1) << 13;    // блок, который помещается в кэш
+constexpr size_t NTT_PARALLEL = size_t(1) << 16; // с такой длины уровни делим между потоками
+
+// Таблица корней: roots[len + j] = w_{2len}^j для всех len = 1, 2, 4, ..., n/2.
+// Так на каждом уровне бабочки ходят по таблице подряд, а не с шагом.
+std::vector<u64> buildRoots(const MontField& f, size_t n) {
+    std::vector<u64> roots(std::max<size_t>(n, 2));
+    for (size_t len = 1; len < n; len <<= 1) {
+        u64 w = f.rootOfUnity(2 * len);
+        u64 cur = f.toMont(1);
+        for (size_t j = 0; j < len; ++j) {
+            roots[len + j] = cur;
+            cur = f.mul(cur, w);
+        }
+    }
+    return roots;
+}
+
+// Прямое преобразование (Gentleman-Sande): натуральный порядок на входе,
+// бит-реверсный на выходе. Перестановку не делаем - поточечному умножению
+// порядок не важен, а обратное преобразование его как раз ожидает.
+// Бабочки j из [lo, hi) одного блока: x - первая половина, y - вторая, w = roots + len
+void forwardButterflies(const MontField& f, u64* x, u64* y, const u64* w, size_t lo, size_t hi) {
+    for (size_t j = lo; j < hi; ++j) {
+        u64 u = x[j], v = y[j];
+        x[j] = f.add(u, v);
+        y[j] = f.mul(f.sub(u, v), w[j]);
+    }
+}
+
+void forwardStage(const MontField& f, u64* a, size_t n, size_t len, const u64* roots) {
+    for (size_t s = 0; s < n; s += 2 * len)
+        forwardButterflies(f, a + s, a + s + len, roots + len, 0, len);
+}
+
+void forward(const MontField& f, u64* a, size_t n, const u64* roots) {
+    if (n <= NTT_LEAF) {
+        for (size_t len = n / 2; len >= 1; len >>= 1)
+            forwardStage(f, a, n, len, roots);
+        return;
+    }
+    // Делаем верхний уровень и уходим в половины, чтобы нижние уровни шли в кэше.
+    // Половины независимы, в параллельном режиме это отдельные задачи
+    const size_t half = n / 2;
+    if (n >= NTT_PARALLEL && parallel::enabled()) {
+        parallel::forChunks(0, half, NTT_LEAF, [&](size_t lo, size_t hi) {
+            forwardButterflies(f, a, a + half, roots + half, lo, hi);
+        });
+        parallel::invoke({
+            [&] { forward(f, a, half, roots); },
+            [&] { forward(f, a + half, half, roots); },
+        });
+        return;
+    }
+    forwardStage(f, a, n, half, roots);
+    forward(f, a, half, roots);
+    forward(f, a + half, half, roots);
+}
+
+// Обратное преобразование (Cooley-Tukey) без нормировки на n.
+// w^{-j} = -w^{len-j} для корня степени 2len, поэтому таблица та же,
+// а знак уходит в перестановку сложения и вычитания.
+void inverseButterflies(const MontField& f, u64* x, u64* y, size_t len, const u64* roots,
+                        size_t lo, size_t hi) {
+    if (lo == 0 && hi > 0) {
+        u64 u = x[0], v = y[0];
+        x[0] = f.add(u, v);
+        y[0] = f.sub(u, v);
+        lo = 1;
+    }
+    for (size_t j = lo; j < hi; ++j) {
+        u64 u = x[j];
+        u64 v = f.mul(y[j], roots[2 * len - j]);
+        x[j] = f.sub(u, v);
+        y[j] = f.add(u, v);
+    }
+}
+
+void inverseStage(const MontField& f, u64* a, size_t n, size_t len, const u64* roots) {
+    for (size_t s = 0; s < n; s += 2 * len)
+        inverseButterflies(f, a + s, a + s + len, len, roots, 0, len);
+}
+
+void inverse(const MontField& f, u64* a, size_t n, const u64* roots) {
+    if (n <= NTT_LEAF) {
+        for (size_t len = 1; len < n; len <<= 1)
+            inverseStage(f, a, n, len, roots);
+        return;
+    }
+    const size_t half = n / 2;
+    if (n >= NTT_PARALLEL && parallel::enabled()) {
+        parallel::invoke({
+            [&] { inverse(f, a, half, roots); },
+            [&] { inverse(f, a + half, half, roots); },
+        });
+        parallel::forChunks(0, half, NTT_LEAF, [&](size_t lo, size_t hi) {
+            inverseButterflies(f, a, a + half, half, roots, lo, hi);
+        });
+        return;
+    }
+    inverse(f, a, half, roots);
+    inverse(f, a + half, half, roots);
+    inverseStage(f, a, n, half, roots);
+}
+
+void load(const MontField& f, u64* dst, size_t n, const u64* src, size_t len) {
+    parallel::forChunks(0, n, NTT_PARALLEL, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < std::min(hi, len); ++i)
+            dst[i] = f.toMont(src[i]);
+        if (hi > len)
+            std::fill(dst + std::max(lo, len), dst + hi, 0);
+    });
+}
+
+// Свёртка a и b по модулю одного простого, результат в обычной (не Монтгомери) форме.
+// Для квадрата (b == a) прямое преобразование одно
+void convolution(const MontField& f, std::vector<u64>& out,
+                 const u64* a, size_t an, const u64* b, size_t bn, size_t n) {
+    std::vector<u64> roots = buildRoots(f, n);
+
+    out.resize(n);
+    load(f, out.data(), n, a, an);
+    forward(f, out.data(), n, roots.data());
+
+    if (a == b && an == bn) {
+        parallel::forChunks(0, n, NTT_PARALLEL, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i)
+                out[i] = f.mul(out[i], out[i]);
+        });
+    } else {
+        std::vector<u64> tmp(n);
+        load(f, tmp.data(), n, b, bn);
+        forward(f, tmp.data(), n, roots.data());
+        parallel::forChunks(0, n, NTT_PARALLEL, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i)
+                out[i] = f.mul(out[i], tmp[i]);
+        });
+    }
+
+    inverse(f, out.data(), n, roots.data());
+
+    // reduce(c * R * n^{-1}) = c: нормировка и выход из формы Монтгомери разом
+    u64 invN = f.fromMont(f.pow(f.toMont(n), f.mod() - 2));
+    parallel::forChunks(0, n, NTT_PARALLEL, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i)
+            out[i] = f.mul(out[i], invN);
+    });
+}
+
+} // namespace
+
+void BigInteger::nttMul(bi_limb_t* rp, const bi_limb_t* ap, size_t an, const bi_limb_t* bp, size_t bn) {
+    BI_STATS_SCOPE(NTT, bn);
+    const size_t rn = an + bn;
+    const size_t coeffs = rn - 1;
+
+    size_t logN = 0;
+    while ((size_t(1) << logN) < coeffs) ++logN;
+    if (logN > NTT_MAX_LOG)
+        throw std::length_error("operands are too large for NTT multiplication");
+    const size_t n = size_t(1) << logN;
+
+    const MontField& f1 = NTT_PRIMES[0];
+    const MontField& f2 = NTT_PRIMES[1];
+    const MontField& f3 = NTT_PRIMES[2];
+
+    // Свёртки по трём модулям независимы (в параллельном режиме - три задачи)
+    std::vector<u64> r1, r2, r3;
+    if (parallel::enabled()) {
+        parallel::invoke({
+            [&] { convolution(f1, r1, ap, an, bp, bn, n); },
+            [&] { convolution(f2, r2, ap, an, bp, bn, n); },
+            [&] { convolution(f3, r3, ap, an, bp, bn, n); },
+        });
+    } else {
+        convolution(f1, r1, ap, an, bp, bn, n);
+        convolution(f2, r2, ap, an, bp, bn, n);
+        convolution(f3, r3, ap, an, bp, bn, n);
+    }
+
+    // Константы Гарнера, заранее в форме Монтгомери соответствующего модуля
+    const u64 p1 = f1.mod(), p2 = f2.mod(), p3 = f3.mod();
+    const u64 inv_p1_mod_p2 = f2.pow(f2.toMont(p1), p2 - 2);
+    const u64 p1_mod_p3 = f3.toMont(p1);
+    const u64 inv_p1p2_mod_p3 = f3.pow(f3.mul(p1_mod_p3, f3.toMont(p2)), p3 - 2);
+    const u128 p1p2 = (u128)p1 * p2;
+    const u64 p1p2_lo = static_cast<u64>(p1p2);
+    const u64 p1p2_hi = static_cast<u64>(p1p2 >> 64);
+
+    u128 carry = 0;
+    for (size_t i = 0; i < rn; ++i) {
+        u64 x1 = 0, x2 = 0, x3 = 0;
+        if (i < coeffs) {
+            x1 = r1[i];
+            x2 = r2[i];
+            x3 = r3[i];
+        }
+
+        // x = x1 + p1 * t2 + p1 * p2 * t3, все слагаемые неотрицательны.
+        // Прибавки кратные p нужны, чтобы разности не уходили в минус.
+        u64 t2 = f2.mul(x2 + 2 * p2 - x1, inv_p1_mod_p2);
+        u64 u = f3.mul(t2, p1_mod_p3);
+        u64 t3 = f3.mul(x3 + 4 * p3 - x1 - u, inv_p1p2_mod_p3);
+
+        u128 lo = x1 + (u128)p1 * t2;
+        u128 mid = (u128)p1p2_lo * t3;
+        u128 hi = (u128)p1p2_hi * t3;
+
+        u128 s = (u128)static_cast<u64>(lo) + static_cast<u64>(mid) + static_cast<u64>(carry);
+        rp[i] = static_cast<bi_limb_t>(s);
+        carry = (s >> 64) + (lo >> 64) + (mid >> 64) + (carry >> 64) + hi;
+    }
+}
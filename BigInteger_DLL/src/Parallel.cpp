@@ -0,0 +1,174 @@
+#include "../include/BigInteger.h"
+#include "Parallel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Пул с общей очередью. Поток, ждущий свои задачи, не просто спит,
+// а выполняет задачи из той же очереди (помощь вместо блокировки).
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned workers) {
+        for (unsigned i = 0; i < workers; ++i)
+            workers_.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& worker : workers_)
+            worker.join();
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    // Выполняет задачи из очереди, пока done() не станет true
+    template <typename Done>
+    void helpUntil(Done done) {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] { return done() || !queue_.empty(); });
+                if (done())
+                    return;
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            task();
+        }
+    }
+
+    // Будит ждущих в helpUntil после завершения задачи
+    void notifyDone() {
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        cv_.notify_all();
+    }
+
+private:
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+                if (queue_.empty())
+                    return;
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
+
+std::mutex configMutex;
+std::unique_ptr<ThreadPool> pool;
+std::atomic<unsigned> activeThreads{1};
+
+void runAll(const std::function<void()>* tasks, size_t count) {
+    ThreadPool* p = pool.get();
+    if (!p || count < 2) {
+        for (size_t i = 0; i < count; ++i)
+            tasks[i]();
+        return;
+    }
+
+    std::atomic<size_t> left{count - 1};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto guarded = [&](const std::function<void()>& task) {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
+    for (size_t i = 1; i < count; ++i) {
+        p->submit([&, p, task = &tasks[i]] {
+            guarded(*task);
+            left.fetch_sub(1, std::memory_order_acq_rel);
+            p->notifyDone();
+        });
+    }
+    guarded(tasks[0]);
+    p->helpUntil([&] { return left.load(std::memory_order_acquire) == 0; });
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} // namespace
+
+namespace parallel {
+
+unsigned threads() {
+    return activeThreads.load(std::memory_order_relaxed);
+}
+
+void invoke(std::initializer_list<std::function<void()>> tasks) {
+    runAll(tasks.begin(), tasks.size());
+}
+
+void forChunks(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+    size_t count = end > begin ? end - begin : 0;
+    size_t chunks = std::min<size_t>(threads(), std::max<size_t>(1, count / std::max<size_t>(grain, 1)));
+    if (chunks <= 1) {
+        if (count)
+            fn(begin, end);
+        return;
+    }
+
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(chunks);
+    for (size_t c = 0; c < chunks; ++c) {
+        size_t lo = begin + count * c / chunks;
+        size_t hi = begin + count * (c + 1) / chunks;
+        tasks.push_back([&fn, lo, hi] { fn(lo, hi); });
+    }
+    runAll(tasks.data(), tasks.size());
+}
+
+} // namespace parallel
+
+void BigInteger::setThreadCount(unsigned threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::lock_guard<std::mutex> lock(configMutex);
+    pool.reset();
+    activeThreads.store(1);
+    if (threads > 1) {
+        pool = std::make_unique<ThreadPool>(threads - 1);
+        activeThreads.store(threads);
+    }
+}
+
+unsigned BigInteger::threadCount() {
+    return parallel::threads();
+}
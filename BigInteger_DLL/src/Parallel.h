@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+
+// Параллельный режим для больших умножений (Parallel.cpp). По умолчанию выключен,
+// включается через BigInteger::setThreadCount. Задачи пишут в непересекающиеся
+// куски памяти, поэтому результат побитово совпадает с последовательным.
+namespace parallel {
+
+// Сколько потоков участвует в вычислениях (1 - всё в вызывающем потоке)
+unsigned threads();
+
+inline bool enabled() { return threads() > 1; }
+
+// Выполняет задачи и возвращается, когда закончены все. Первую задачу берёт
+// вызывающий поток, пока ждёт остальные - помогает с очередью пула, так что
+// вложенные вызовы не блокируют друг друга. Исключение из задачи пробрасывается.
+void invoke(std::initializer_list<std::function<void()>> tasks);
+
+// fn(lo, hi) для кусков [begin, end) длиной не меньше grain
+void forChunks(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+} // namespace parallel
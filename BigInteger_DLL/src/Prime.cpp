@@ -0,0 +1,351 @@
+#include "../include/BigInteger.h"
+#include "../include/MontgomeryContext.h"
+#include "LimbKernels.h"
+#include "Scratch.h"
+
+#include <array>
+#include <bit>
+
+// Проверки простоты. До 2^64 - пробное деление и Миллер-Рабин по первым 12
+// простым основаниям, это точный ответ. Дальше BPSW: Миллер-Рабин по основанию 2
+// и сильный тест Люка с параметрами Селфриджа, оба прямо в форме Монтгомери
+// (сложение, вычитание и деление пополам с ней совместимы, умножение - mul/REDC).
+// Для чисел Мерсенна отдельный тест Люка-Лемера: 2^p = 1 (mod 2^p - 1), так что
+// остаток квадрата - сумма его младших p бит и всего, что выше.
+
+namespace {
+
+using limb_t = BigInteger::bi_limb_t;
+
+// Пробное деление - на простые меньше TRIAL_LIMIT, их ровно SMALL_PRIME_COUNT
+constexpr unsigned TRIAL_LIMIT = 1000;
+constexpr size_t SMALL_PRIME_COUNT = 168;
+// Если столько D подряд не дали (D / n) = -1, проверяем, не квадрат ли n
+constexpr int SQUARE_CHECK_TRIES = 20;
+
+constexpr std::array<unsigned, SMALL_PRIME_COUNT> SMALL_PRIMES = [] {
+    std::array<unsigned, SMALL_PRIME_COUNT> primes{};
+    size_t count = 0;
+    for (unsigned v = 2; v < TRIAL_LIMIT; ++v) {
+        bool prime = true;
+        for (size_t i = 0; i < count && primes[i] * primes[i] <= v; ++i)
+            prime = prime && v % primes[i] != 0;
+        if (prime)
+            primes[count++] = v;
+    }
+    return primes;
+}();
+
+limb_t mulmod64(limb_t a, limb_t b, limb_t m) {
+    return static_cast<limb_t>((unsigned __int128)a * b % m);
+}
+
+limb_t powmod64(limb_t a, limb_t e, limb_t m) {
+    limb_t res = 1;
+    for (; e; e >>= 1) {
+        if (e & 1)
+            res = mulmod64(res, a, m);
+        a = mulmod64(a, a, m);
+    }
+    return res;
+}
+
+// Сильный тест по основанию a для нечётного n > a
+bool millerRabin64(limb_t n, limb_t a) {
+    const int s = std::countr_zero(n - 1);
+    limb_t x = powmod64(a, (n - 1) >> s, n);
+    if (x == 1 || x == n - 1)
+        return true;
+    for (int r = 1; r < s; ++r) {
+        x = mulmod64(x, x, n);
+        if (x == n - 1)
+            return true;
+    }
+    return false;
+}
+
+// Основания 2, ..., 37 не пропускают ни одного составного меньше 3.3 * 10^24
+bool isPrime64(limb_t n) {
+    if (n < 2)
+        return false;
+    for (unsigned p : SMALL_PRIMES) {
+        if (n % p == 0)
+            return n == p;
+        if (limb_t(p) * p > n)
+            return true;
+    }
+    for (limb_t a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+        if (!millerRabin64(n, a))
+            return false;
+    }
+    return true;
+}
+
+// Делится ли n на одно из малых простых: простые склеиваем в лимб, на группу - один mod_1
+bool hasSmallFactor(const limb_t* np, size_t n) {
+    for (size_t i = 0; i < SMALL_PRIME_COUNT;) {
+        limb_t product = 1;
+        size_t j = i;
+        while (j < SMALL_PRIME_COUNT && product <= ~limb_t(0) / SMALL_PRIMES[j])
+            product *= SMALL_PRIMES[j++];
+        const limb_t r = mpn::mod_1(np, n, product);
+        for (; i < j; ++i) {
+            if (r % SMALL_PRIMES[i] == 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+// Символ Якоби (a / n), n нечётное
+int jacobi(limb_t a, limb_t n) {
+    int res = 1;
+    a %= n;
+    while (a) {
+        const int twos = std::countr_zero(a);
+        a >>= twos;
+        if ((twos & 1) && (n % 8 == 3 || n % 8 == 5))
+            res = -res;
+        if (a % 4 == 3 && n % 4 == 3)
+            res = -res;
+        std::swap(a, n);
+        a %= n;
+    }
+    return n == 1 ? res : 0;
+}
+
+// (d / n) для малого d != 0 и длинного нечётного n: знак и двойки отдельно,
+// дальше взаимность сводит всё к (n mod |d| / |d|)
+int jacobi(long long d, const limb_t* np, size_t n) {
+    int res = 1;
+    limb_t a = d < 0 ? 0 - static_cast<limb_t>(d) : static_cast<limb_t>(d);
+    if (d < 0 && np[0] % 4 == 3)
+        res = -res;
+    const int twos = std::countr_zero(a);
+    a >>= twos;
+    if ((twos & 1) && (np[0] % 8 == 3 || np[0] % 8 == 5))
+        res = -res;
+    if (a % 4 == 3 && np[0] % 4 == 3)
+        res = -res;
+    return res * jacobi(mpn::mod_1(np, n, a), a);
+}
+
+// Остатки по модулю m в n лимбах, аргументы в [0, m)
+void addMod(limb_t* rp, const limb_t* ap, const limb_t* bp, const limb_t* mp, size_t n) {
+    if (mpn::add_n(rp, ap, bp, n) || mpn::cmp(rp, mp, n) >= 0)
+        mpn::sub_n(rp, rp, mp, n);
+}
+
+void subMod(limb_t* rp, const limb_t* ap, const limb_t* bp, const limb_t* mp, size_t n) {
+    if (mpn::sub_n(rp, ap, bp, n))
+        mpn::add_n(rp, rp, mp, n);
+}
+
+// rp / 2 mod m для нечётного m: у нечётного сначала прибавляем m
+void halfMod(limb_t* rp, const limb_t* mp, size_t n) {
+    const limb_t carry = rp[0] & 1 ? mpn::add_n(rp, rp, mp, n) : 0;
+    mpn::rshift(rp, rp, n, 1);
+    rp[n - 1] |= carry << 63;
+}
+
+bool isZeroLimbs(const limb_t* ap, size_t n) {
+    return std::all_of(ap, ap + n, [](limb_t v) { return v == 0; });
+}
+
+// Псевдослучайные основания для дополнительных раундов
+limb_t splitmix64(limb_t& state) {
+    limb_t z = state += 0x9e3779b97f4a7c15;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+} // namespace
+
+// m - 1 = d * 2^s: base^d = 1 или base^(d 2^r) = -1 при каком-то r < s
+bool BigInteger::millerRabin(const MontgomeryContext& ctx, const BigInteger& base) {
+    const BigInteger& m = ctx.modulus_;
+    const size_t n = ctx.n_;
+    const limb_t* mp = m.limbs_.data();
+
+    BigInteger d = m - BigInteger(1);
+    const size_t s = d.trailingZeros();
+    d >>= s;
+
+    scratch::Frame frame;
+    limb_t* tp = frame.alloc(ctx.scratchSize());
+    limb_t* xp = frame.alloc(n);
+    limb_t* minusOne = frame.alloc(n);
+    const limb_t* one = ctx.one_.data();
+    mpn::sub_n(minusOne, mp, one, n);
+
+    ctx.load(xp, ctx.modPow(base, d));
+    ctx.toDomain(xp, xp, tp);
+    if (mpn::cmp(xp, one, n) == 0 || mpn::cmp(xp, minusOne, n) == 0)
+        return true;
+    for (size_t r = 1; r < s; ++r) {
+        ctx.mul(xp, xp, xp, tp);
+        if (mpn::cmp(xp, minusOne, n) == 0)
+            return true;
+        if (mpn::cmp(xp, one, n) == 0)
+            return false;       // нетривиальный корень из 1
+    }
+    return false;
+}
+
+// Сильный тест Люка с P = 1, Q = (1 - D) / 4 для нечётного m > 2^64 без малых
+// делителей. m + 1 = d * 2^s: U_d = 0 или V_(d 2^r) = 0 при каком-то r < s.
+// U, V и Q^k ведём слева направо по битам d:
+//   U_2k = U_k V_k,  V_2k = V_k^2 - 2 Q^k,
+//   U_2k+1 = (U_2k + V_2k) / 2,  V_2k+1 = (D U_2k + V_2k) / 2
+bool BigInteger::strongLucas(const MontgomeryContext& ctx) {
+    const BigInteger& m = ctx.modulus_;
+    const size_t n = ctx.n_;
+    const limb_t* mp = m.limbs_.data();
+
+    // Селфридж: первое D из 5, -7, 9, -11, ... с (D / m) = -1. У квадрата такого нет
+    long long D = 5;
+    for (int tries = 1;; ++tries) {
+        const int j = jacobi(D, mp, n);
+        if (j == -1)
+            break;
+        if (j == 0)
+            return false;       // общий делитель с |D| < m
+        if (tries == SQUARE_CHECK_TRIES && m.sqrtRem().second.isZero())
+            return false;
+        D = D > 0 ? -(D + 2) : 2 - D;
+    }
+    const long long Q = (1 - D) / 4;
+
+    BigInteger d = m + BigInteger(1);
+    const size_t s = d.trailingZeros();
+    d >>= s;
+
+    scratch::Frame frame;
+    limb_t* tp = frame.alloc(ctx.scratchSize());
+    limb_t* up = frame.alloc(n);
+    limb_t* vp = frame.alloc(n);
+    limb_t* qk = frame.alloc(n);        // Q^k
+    limb_t* qp = frame.alloc(n);        // Q
+    limb_t* dp = frame.alloc(n);        // D
+    limb_t* du = frame.alloc(n);        // D U_2k
+
+    ctx.load(qp, BigInteger(Q));
+    ctx.toDomain(qp, qp, tp);
+    ctx.load(dp, BigInteger(D));
+    ctx.toDomain(dp, dp, tp);
+    std::copy(ctx.one_.begin(), ctx.one_.end(), up);     // U_1 = 1
+    std::copy(ctx.one_.begin(), ctx.one_.end(), vp);     // V_1 = P = 1
+    std::copy(qp, qp + n, qk);
+
+    for (size_t i = d.bitLength() - 1; i-- > 0;) {
+        ctx.mul(up, up, vp, tp);
+        ctx.mul(vp, vp, vp, tp);
+        subMod(vp, vp, qk, mp, n);
+        subMod(vp, vp, qk, mp, n);
+        ctx.mul(qk, qk, qk, tp);
+        if (d.testBit(i)) {
+            ctx.mul(du, dp, up, tp);
+            addMod(up, up, vp, mp, n);
+            halfMod(up, mp, n);
+            addMod(vp, vp, du, mp, n);
+            halfMod(vp, mp, n);
+            ctx.mul(qk, qk, qp, tp);
+        }
+    }
+
+    if (isZeroLimbs(up, n) || isZeroLimbs(vp, n))
+        return true;
+    for (size_t r = 1; r < s; ++r) {
+        ctx.mul(vp, vp, vp, tp);
+        subMod(vp, vp, qk, mp, n);
+        subMod(vp, vp, qk, mp, n);
+        if (isZeroLimbs(vp, n))
+            return true;
+        ctx.mul(qk, qk, qk, tp);
+    }
+    return false;
+}
+
+bool BigInteger::isProbablePrime(unsigned rounds) const {
+    if (negative_ || isZero())
+        return false;
+    const limb_t* np = limbs_.data();
+    const size_t n = limbs_.size();
+    if (n == 1)
+        return isPrime64(np[0]);
+    if (!(np[0] & 1) || hasSmallFactor(np, n))
+        return false;
+
+    MontgomeryContext ctx(*this);
+    if (!millerRabin(ctx, BigInteger(2)) || !strongLucas(ctx))
+        return false;
+
+    // Основания меньше 2^64 < n, от числа зависят только через seed
+    limb_t state = np[0] ^ n;
+    for (unsigned i = 0; i < rounds; ++i) {
+        limb_t a = std::max<limb_t>(splitmix64(state), 3);
+        if (!millerRabin(ctx, fromLimbs({&a, 1})))
+            return false;
+    }
+    return true;
+}
+
+// s_0 = 4, s_(i+1) = s_i^2 - 2 mod M, M = 2^p - 1 простое тогда и только тогда,
+// когда s_(p-2) = 0. s держим в [0, M) на n = ceil(p / 64) лимбах
+bool BigInteger::lucasLehmer(unsigned long long p) {
+    if (p == 2)
+        return true;
+    if (!isPrime64(p))
+        return false;       // при p = ab число 2^p - 1 делится на 2^a - 1
+
+    const size_t n = (p + 63) / 64;
+    const size_t q = p / 64;
+    const unsigned r = p % 64;
+    const limb_t topMask = r ? (limb_t(1) << r) - 1 : ~limb_t(0);
+
+    scratch::Frame frame(mulScratchSize(n, n) + 5 * n);
+    limb_t* sp = frame.alloc(n);
+    limb_t* tp = frame.alloc(2 * n);
+    limb_t* hp = frame.alloc(2 * n);
+    std::fill(sp, sp + n, 0);
+    sp[0] = 4;
+
+    auto isModulus = [&] {
+        for (size_t i = 0; i + 1 < n; ++i) {
+            if (sp[i] != ~limb_t(0))
+                return false;
+        }
+        return sp[n - 1] == topMask;
+    };
+
+    for (unsigned long long i = 2; i < p; ++i) {
+        mulLimbs(tp, sp, n, sp, n);
+
+        // s^2 = hi * 2^p + lo = hi + lo (mod M), hi и lo меньше 2^p
+        if (r)
+            mpn::rshift(hp, tp + q, 2 * n - q, r);
+        else
+            std::copy(tp + q, tp + 2 * n, hp);
+        tp[n - 1] &= topMask;
+        const limb_t carry = mpn::add_n(sp, tp, hp, n);
+
+        // Сумма меньше 2^(p+1): бит p ещё раз переносим в младший, выходит не больше M
+        const limb_t over = r ? sp[n - 1] >> r : carry;
+        sp[n - 1] &= topMask;
+        mpn::add_1(sp, sp, n, over);
+        if (isModulus())
+            std::fill(sp, sp + n, 0);
+
+        // s - 2 mod M, у 0 и 1 заём: M - (2 - s)
+        if (sp[0] < 2 && isZeroLimbs(sp + 1, n - 1)) {
+            const limb_t low = sp[0];
+            std::fill(sp, sp + n, ~limb_t(0));
+            sp[n - 1] = topMask;
+            sp[0] -= 2 - low;
+        } else {
+            mpn::sub_1(sp, sp, n, 2);
+        }
+    }
+    return isZeroLimbs(sp, n);
+}
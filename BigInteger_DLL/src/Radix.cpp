@@ -0,0 +1,269 @@
+#include "../include/BigInteger.h"
+#include "LimbKernels.h"
+#include "Stats.h"
+
+#include <cmath>
+#include <deque>
+#include <mutex>
+
+// Перевод между BigInteger и строками цифр.
+// Цифры группируем в "большие цифры" по основанию base^k, помещающемуся в лимб
+// (для десятичной системы это 10^19), а длинные строки делим пополам и
+// склеиваем через закэшированные степени (base^k)^(2^i) - так вся работа
+// ложится на быстрое умножение, а не на квадратичный проход по цифрам.
+
+namespace {
+
+// Сколько цифр помещается в лимб и чему равно соответствующее основание
+struct RadixInfo {
+    size_t digits;
+    BigInteger::bi_limb_t bigBase;
+};
+
+constexpr char DIGITS_LOWER[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+constexpr char DIGITS_UPPER[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+void checkBase(int base) {
+    if (base < 2 || base > 36)
+        throw std::invalid_argument("base must be in [2, 36]");
+}
+
+RadixInfo radixInfo(unsigned base) {
+    RadixInfo info{0, 1};
+    while (info.bigBase <= ~BigInteger::bi_limb_t(0) / base) {
+        info.bigBase *= base;
+        ++info.digits;
+    }
+    return info;
+}
+
+} // namespace
+
+const BigInteger& BigInteger::radixPower(unsigned base, size_t k) {
+    static std::mutex mutex;
+    static std::deque<BigInteger> cache[37];    // deque не двигает элементы при росте
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& powers = cache[base];
+    if (powers.empty()) {
+        BigInteger first(0);
+        first.limbs_[0] = radixInfo(base).bigBase;
+        powers.push_back(std::move(first));
+    }
+    while (powers.size() <= k)
+        powers.push_back(powers.back() * powers.back());
+    return powers[k];
+}
+
+// Склеивает count больших цифр (chunks[0] - младшая) в число
+BigInteger BigInteger::fromChunks(const bi_limb_t* chunks, size_t count, unsigned base) {
+    BI_STATS_SCOPE(Parse, count);
+    if (count <= RADIX_THRESHOLD) {
+        // Схема Горнера прямо по лимбам: res = res * bigBase + chunk
+        const bi_limb_t bigBase = radixInfo(base).bigBase;
+        BigInteger res;
+        res.limbs_.assign(count + 1, 0);
+        size_t len = 0;
+        for (size_t i = count; i-- > 0;) {
+            bi_limb_t* p = res.limbs_.data();
+            bi_limb_t carry = mpn::mul_1(p, p, len, bigBase, chunks[i]);
+            if (carry) p[len++] = carry;
+        }
+        res.normalize();
+        return res;
+    }
+
+    // Младшая часть - ровно 2^k больших цифр, старшая - всё остальное
+    size_t k = 0;
+    while ((size_t(2) << k) < count) ++k;
+    size_t lowCount = size_t(1) << k;
+
+    BigInteger res = fromChunks(chunks + lowCount, count - lowCount, base);
+    res *= radixPower(base, k);
+    res += fromChunks(chunks, lowCount, base);
+    return res;
+}
+
+BigInteger BigInteger::fromDigits(std::string_view digits) {
+    const RadixInfo info = radixInfo(10);
+    const size_t count = (digits.size() + info.digits - 1) / info.digits;
+
+    // Режем на большие цифры с конца строки, старшая может быть короче
+    std::vector<bi_limb_t> chunks(count);
+    size_t end = digits.size();
+    for (size_t i = 0; i < count; ++i) {
+        size_t begin = end >= info.digits ? end - info.digits : 0;
+        bi_limb_t chunk = 0;
+        for (size_t p = begin; p < end; ++p)
+            chunk = chunk * 10 + (digits[p] - '0');
+        chunks[i] = chunk;
+        end = begin;
+    }
+
+    if (count == 0)
+        return BigInteger(0);
+    return fromChunks(chunks.data(), count, 10);
+}
+
+BigInteger::BigInteger(std::string_view str) : negative_(false) {
+    size_t pos = 0;
+    if (!str.empty() && str[0] == '-')
+        pos = 1;
+    for (size_t i = pos; i < str.size(); ++i) {
+        if (!isdigit(static_cast<unsigned char>(str[i])))
+            throw std::runtime_error("invalid digit");
+    }
+
+    *this = fromDigits(str.substr(pos));
+    negative_ = pos == 1;
+    normalize();
+}
+
+std::from_chars_result from_chars(const char* first, const char* last, BigInteger& value) {
+    const char* pos = first;
+    bool negative = false;
+    if (pos != last && *pos == '-') {
+        negative = true;
+        ++pos;
+    }
+
+    const char* digitsBegin = pos;
+    while (pos != last && *pos >= '0' && *pos <= '9')
+        ++pos;
+    if (pos == digitsBegin)
+        return {first, std::errc::invalid_argument};
+
+    value = BigInteger::fromDigits(std::string_view(digitsBegin, pos - digitsBegin));
+    value.negative_ = negative;
+    value.normalize();
+    return {pos, std::errc()};
+}
+
+// Ровно count больших цифр |x| (младшая первой), старшие при необходимости нули
+void BigInteger::toChunks(const BigInteger& x, unsigned base, bi_limb_t* out, size_t count) {
+    BI_STATS_SCOPE(Format, x.limbs_.size());
+    if (x.limbs_.size() <= RADIX_THRESHOLD) {
+        // Маленькие числа - делением на большую цифру за лимб
+        const bi_limb_t bigBase = radixInfo(base).bigBase;
+        BigInteger rest = x;
+        for (size_t i = 0; i < count; ++i)
+            out[i] = rest.isZero() ? 0 : divLimb(rest, bigBase);
+        return;
+    }
+
+    // Делим на закэшированную степень так, чтобы младшая часть была из 2^k больших цифр
+    size_t k = 0;
+    while ((size_t(2) << k) < count) ++k;
+    size_t lowCount = size_t(1) << k;
+
+    auto [high, low] = divMod(x, radixPower(base, k));
+    toChunks(low, base, out, lowCount);
+    toChunks(high, base, out + lowCount, count - lowCount);
+}
+
+// Большие цифры |*this| без ведущих нулевых (хотя бы одна)
+std::vector<BigInteger::bi_limb_t> BigInteger::toChunks(unsigned base) const {
+    const RadixInfo info = radixInfo(base);
+    const size_t top = limbs_.empty() ? 0 : limbs_.back();
+    const size_t bits = top ? 64 * (limbs_.size() - 1) + (64 - __builtin_clzll(top)) : 0;
+
+    std::vector<bi_limb_t> chunks;
+    if ((base & (base - 1)) == 0) {
+        // Степень двойки: большая цифра - просто поле из chunkBits бит
+        const size_t chunkBits = info.digits * __builtin_ctz(base);
+        chunks.resize(std::max<size_t>(1, (bits + chunkBits - 1) / chunkBits));
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            size_t pos = i * chunkBits;
+            size_t limb = pos / 64, offset = pos % 64;
+            bi_limb_t v = limbs_[limb] >> offset;
+            if (offset + chunkBits > 64 && limb + 1 < limbs_.size())
+                v |= limbs_[limb + 1] << (64 - offset);
+            chunks[i] = v & ((bi_limb_t(1) << chunkBits) - 1);
+        }
+    } else {
+        // Оценка сверху числа больших цифр, лишние нули потом отрежем
+        size_t count = static_cast<size_t>(bits / std::log2(static_cast<double>(info.bigBase))) + 2;
+        chunks.resize(count);
+        BigInteger mag = *this;
+        mag.negative_ = false;
+        toChunks(mag, base, chunks.data(), count);
+    }
+
+    while (chunks.size() > 1 && chunks.back() == 0)
+        chunks.pop_back();
+    return chunks;
+}
+
+size_t BigInteger::formatChunks(const std::vector<bi_limb_t>& chunks, unsigned base,
+                                bool uppercase, char* out) {
+    const RadixInfo info = radixInfo(base);
+    const char* alphabet = uppercase ? DIGITS_UPPER : DIGITS_LOWER;
+
+    // Старшая большая цифра без ведущих нулей, остальные дополнены до info.digits
+    char head[64];
+    size_t headLen = 0;
+    for (bi_limb_t v = chunks.back(); v || headLen == 0; v /= base)
+        head[headLen++] = alphabet[v % base];
+
+    size_t total = headLen + (chunks.size() - 1) * info.digits;
+    if (!out)
+        return total;
+
+    std::reverse_copy(head, head + headLen, out);
+    char* p = out + total;
+    for (size_t i = 0; i + 1 < chunks.size(); ++i) {
+        bi_limb_t v = chunks[i];
+        for (size_t d = 0; d < info.digits; ++d) {
+            *--p = alphabet[v % base];
+            v /= base;
+        }
+    }
+    return total;
+}
+
+std::string BigInteger::toString(int base) const {
+    checkBase(base);
+    auto chunks = toChunks(base);
+    size_t sign = negative_ && !isZero() ? 1 : 0;
+
+    std::string res(sign + formatChunks(chunks, base, false, nullptr), '-');
+    formatChunks(chunks, base, false, res.data() + sign);
+    return res;
+}
+
+std::to_chars_result to_chars(char* first, char* last, const BigInteger& value, int base) {
+    checkBase(base);
+    auto chunks = value.toChunks(base);
+    size_t sign = value.negative_ && !value.isZero() ? 1 : 0;
+
+    size_t len = sign + BigInteger::formatChunks(chunks, base, false, nullptr);
+    if (static_cast<size_t>(last - first) < len)
+        return {last, std::errc::value_too_large};
+
+    if (sign) *first = '-';
+    BigInteger::formatChunks(chunks, base, false, first + sign);
+    return {first + len, std::errc()};
+}
+
+// Вывод учитывает std::hex / std::oct / std::dec, std::uppercase и std::showbase
+std::ostream& operator<<(std::ostream& stream, const BigInteger& bigint) {
+    unsigned base = 10;
+    auto basefield = stream.flags() & std::ios_base::basefield;
+    if (basefield == std::ios_base::hex) base = 16;
+    else if (basefield == std::ios_base::oct) base = 8;
+    bool uppercase = stream.flags() & std::ios_base::uppercase;
+
+    auto chunks = bigint.toChunks(base);
+    std::string res;
+    if (bigint.negative_ && !bigint.isZero())
+        res += '-';
+    if (stream.flags() & std::ios_base::showbase) {
+        if (base == 16) res += uppercase ? "0X" : "0x";
+        else if (base == 8) res += "0";
+    }
+
+    size_t prefix = res.size();
+    res.resize(prefix + BigInteger::formatChunks(chunks, base, uppercase, nullptr));
+    BigInteger::formatChunks(chunks, base, uppercase, res.data() + prefix);
+    return stream << res;
+}
@@ -0,0 +1,245 @@
+#include "../include/BigInteger.h"
+#include "LimbKernels.h"
+
+#include <bit>
+#include <cmath>
+
+// Корни методом Ньютона с удвоением точности. Корень из n / 2^(ks) (рекурсивно,
+// вдвое короче) после сдвига на s бит ниже настоящего меньше чем на 2^s, один шаг
+// x' = ((k - 1) x + n / x^(k-1)) / k на полной длине делает ошибку квадратично
+// меньше: получается корень или на единицу больше. Длины уровней убывают вдвое,
+// так что всё вместе - несколько умножений и делений полной длины.
+// Точные степени ищем 2-адически: у нечётного m и нечётного k корень по модулю 2^w
+// единственный, его поднимаем Хензелем до длины возможного корня и возводим в
+// степень только кандидатов, прошедших проверку длины и остатка по модулю 2^61 - 1.
+
+namespace {
+
+using limb_t = BigInteger::bi_limb_t;
+
+// Пока корень не длиннее стольких бит (плюс запас на k), приближение берём из double
+constexpr size_t ROOT_BASE_BITS = 64;
+// Простое 2^61 - 1 для отбраковки кандидатов в isPerfectPower
+constexpr limb_t CHECK_PRIME = (limb_t(1) << 61) - 1;
+// 63 * 65 * 11: по остаткам от них отсеиваются почти все неквадраты
+constexpr limb_t SQUARE_FILTER = 45045;
+
+// Корень из n > 0 сверху из старших двух лимбов через double: ошибка log2 n
+// порядка 2^-45, запас 2^-30 с лихвой, так что оценка не меньше корня
+BigInteger rootEstimate(const BigInteger& n, unsigned long long k) {
+    auto limbs = n.get_limbs();
+    const size_t size = limbs.size();
+    const double log2n = size == 1 ? std::log2(double(limbs[0]))
+        : std::log2(std::ldexp(double(limbs[size - 1]), 64) + double(limbs[size - 2])) + 64.0 * double(size - 2);
+    const double l = log2n / double(k);
+    const long e = std::max(0L, long(l) - 52);
+    limb_t m = limb_t(std::exp2(l - double(e)));
+    m += (m >> 30) + 2;
+    return BigInteger::fromLimbs({&m, 1}) << size_t(e);
+}
+
+// Целая часть корня k-й степени из n > 0, k >= 2; в power кладётся её k-я степень
+BigInteger rootFloor(const BigInteger& n, unsigned long long k, BigInteger& power) {
+    const size_t bits = n.bitLength();
+    const size_t kBits = std::bit_width(k);
+    if (bits <= k) {
+        power = BigInteger(1);      // 1 <= n < 2^k
+        return BigInteger(1);
+    }
+
+    BigInteger x;
+    if (bits / k <= ROOT_BASE_BITS + 2 * kBits) {
+        x = rootEstimate(n, k);
+    } else {
+        // Ошибка после шага не больше (k - 1) 2^(2s) / 2x < 1/4
+        const size_t s = (bits / k - kBits - 2) / 2;
+        BigInteger low;
+        x = rootFloor(n >> (k * s), k, low) << s;
+        x = ((k - 1) * x + n / x.pow(k - 1)) / k;
+    }
+
+    // x не меньше корня: пока x^k > n, шаг Ньютона строго уменьшает x и не проскакивает корень
+    for (;;) {
+        BigInteger p = x.pow(k - 1);
+        power = p * x;
+        if (power <= n)
+            return x;
+        x = ((k - 1) * x + n / p) / k;
+    }
+}
+
+// x mod 2^bits для x >= 0
+BigInteger lowBits(const BigInteger& x, size_t bits) {
+    auto limbs = x.get_limbs();
+    const size_t n = (bits + 63) / 64;
+    if (limbs.size() < n)
+        return x;
+    std::vector<limb_t> low(limbs.begin(), limbs.begin() + n);
+    if (bits % 64)
+        low[n - 1] &= (limb_t(1) << (bits % 64)) - 1;
+    return BigInteger::fromLimbs(low);
+}
+
+// x^e mod 2^bits, e >= 1
+BigInteger powLow(const BigInteger& x, unsigned long long e, size_t bits) {
+    BigInteger res = x;
+    for (int i = std::bit_width(e) - 1; i-- > 0;) {
+        res = lowBits(res * res, bits);
+        if ((e >> i) & 1)
+            res = lowBits(res * x, bits);
+    }
+    return res;
+}
+
+// x / d mod 2^bits для нечётного d (деление Хенселя снизу вверх)
+BigInteger divLow(const BigInteger& x, limb_t d, size_t bits) {
+    std::vector<limb_t> q((bits + 63) / 64, 0);
+    auto limbs = x.get_limbs();
+    std::copy(limbs.begin(), limbs.begin() + std::min(limbs.size(), q.size()), q.begin());
+    mpn::divexact_1(q.data(), q.data(), q.size(), d);
+    return lowBits(BigInteger::fromLimbs(q), bits);
+}
+
+limb_t inverse64(limb_t a) {
+    limb_t inv = a;                     // a^{-1} mod 2^64 для нечётного a
+    for (int i = 0; i < 5; ++i)
+        inv *= 2 - a * inv;
+    return inv;
+}
+
+limb_t pow64(limb_t a, limb_t e) {
+    limb_t res = 1;
+    for (; e; e >>= 1, a *= a) {
+        if (e & 1)
+            res *= a;
+    }
+    return res;
+}
+
+limb_t powmodCheck(limb_t a, unsigned long long e) {
+    limb_t res = 1;
+    for (; e; e >>= 1) {
+        if (e & 1)
+            res = static_cast<limb_t>((unsigned __int128)res * a % CHECK_PRIME);
+        a = static_cast<limb_t>((unsigned __int128)a * a % CHECK_PRIME);
+    }
+    return res;
+}
+
+limb_t modCheck(const BigInteger& x) {
+    auto limbs = x.get_limbs();
+    return mpn::mod_1(limbs.data(), limbs.size(), CHECK_PRIME);
+}
+
+bool quadraticResidue(limb_t r, limb_t q) {
+    for (limb_t i = 0; i <= q / 2; ++i) {
+        if (i * i % q == r)
+            return true;
+    }
+    return false;
+}
+
+// Может ли нечётное m быть квадратом: 1 по модулю 8 и вычеты по модулю 63, 65, 11
+bool maybeSquare(const BigInteger& m) {
+    auto limbs = m.get_limbs();
+    if (limbs[0] % 8 != 1)
+        return false;
+    const limb_t r = mpn::mod_1(limbs.data(), limbs.size(), SQUARE_FILTER);
+    return quadraticResidue(r % 63, 63) && quadraticResidue(r % 65, 65) && quadraticResidue(r % 11, 11);
+}
+
+// Нечётное m > 1 - k-я степень для нечётного простого k? Корень a < 2^w, w = ceil(bits / k).
+// По модулю 2^64 a = m^(1/k mod 2^62), дальше r = m^(-1/k) поднимаем
+// r' = r + r (1 - m r^k) / k до w бит и берём a = m r^(k-1) mod 2^w
+bool isOddPower(const BigInteger& m, unsigned long long k, limb_t mCheck) {
+    const size_t bits = m.bitLength();
+    const size_t w = (bits + k - 1) / k;
+    const limb_t a0 = pow64(m.get_limbs()[0], inverse64(k));
+
+    BigInteger a;
+    if (w <= 64) {
+        a = lowBits(BigInteger::fromLimbs({&a0, 1}), w);
+    } else {
+        const limb_t r0 = inverse64(a0);
+        BigInteger r = BigInteger::fromLimbs({&r0, 1});
+        for (size_t prec = 64; prec < w;) {
+            prec = std::min(2 * prec, w);
+            BigInteger t = lowBits(lowBits(m, prec) * powLow(r, k, prec), prec);
+            BigInteger e = lowBits((BigInteger(1) << prec) + 1 - t, prec);
+            r = lowBits(r + r * divLow(e, k, prec), prec);
+        }
+        a = lowBits(lowBits(m, w) * powLow(r, k - 1, w), w);
+    }
+
+    // a^k длиной ровно bits бит и с тем же остатком, иначе не степень
+    const size_t aBits = a.bitLength();
+    if (aBits == 0 || bits <= (aBits - 1) * k || bits > aBits * k)
+        return false;
+    if (powmodCheck(modCheck(a), k) != mCheck)
+        return false;
+    return a.pow(k) == m;
+}
+
+} // namespace
+
+BigInteger BigInteger::isqrt() const {
+    return sqrtRem().first;
+}
+
+std::pair<BigInteger, BigInteger> BigInteger::sqrtRem() const {
+    if (negative_)
+        throw std::invalid_argument("sqrtRem: negative argument");
+    if (isZero())
+        return {BigInteger(0), BigInteger(0)};
+    BigInteger square;
+    BigInteger root = rootFloor(*this, 2, square);
+    return {std::move(root), *this - square};
+}
+
+BigInteger BigInteger::nthRoot(unsigned long long k) const {
+    if (k == 0)
+        throw std::invalid_argument("nthRoot: zero degree");
+    if (negative_ && k % 2 == 0)
+        throw std::invalid_argument("nthRoot: even degree root of a negative number");
+    if (k == 1 || isZero())
+        return *this;
+
+    BigInteger power;
+    BigInteger res = rootFloor(BigInteger(BigIntegerView(*this).abs()), k, power);
+    res.negative_ = negative_;
+    return res;
+}
+
+// m = 2^t * (нечётное), a^k = m требует k | t. Хватает простых k: a^(pq) = (a^p)^q
+bool BigInteger::isPerfectPower() const {
+    BigInteger m(BigIntegerView(*this).abs());
+    if (m <= BigInteger(1))
+        return true;
+    const size_t t = m.trailingZeros();
+    m >>= t;
+    auto allowed = [&](unsigned long long k) {
+        return (t == 0 || t % k == 0) && !(negative_ && k == 2);
+    };
+
+    if (m == BigInteger(1)) {
+        // 2^t: у положительных годится любой делитель t > 1, у отрицательных - нечётный
+        return negative_ ? !std::has_single_bit(t) : t > 1;
+    }
+
+    if (allowed(2) && maybeSquare(m) && m.sqrtRem().second.isZero())
+        return true;
+
+    // Нечётные простые k до длины m решетом
+    const size_t bits = m.bitLength();
+    std::vector<bool> composite(bits + 1);
+    const limb_t mCheck = modCheck(m);
+    for (size_t k = 3; k <= bits; k += 2) {
+        if (composite[k])
+            continue;
+        for (size_t j = k * k; j <= bits; j += 2 * k)
+            composite[j] = true;
+        if (allowed(k) && isOddPower(m, k, mCheck))
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../include/BigInteger.h"
+#include "Stats.h"
+
+#include <memory>
+#include <vector>
+
+// Временная память для рекурсивных алгоритмов умножения и деления.
+// У каждого потока своя арена: память выдаётся сдвигом указателя и
+// возвращается целиком при выходе из Frame. Блоки живут между вызовами,
+// поэтому повторные умножения обходятся без обращений к общему аллокатору.
+namespace scratch {
+
+using limb_t = BigInteger::bi_limb_t;
+
+class Arena {
+public:
+    // Позиция в арене, к которой можно откатиться
+    struct Mark {
+        size_t block;
+        size_t used;
+    };
+
+    Mark mark() const { return {current_, used_}; }
+
+    void release(Mark m) {
+        current_ = m.block;
+        used_ = m.used;
+        if (current_ == 0 && used_ == 0)
+            trim();
+    }
+
+    // Заказ памяти под весь верхнеуровневый вызов: пока арена свободна,
+    // склеиваем блоки в один достаточного размера. Внутри рекурсии ничего не делает.
+    void reserve(size_t n) {
+        if (current_ != 0 || used_ != 0)
+            return;
+        if (!blocks_.empty() && blocks_[0].size >= n)
+            return;
+        blocks_.clear();
+        BI_STATS_ALLOC(n * sizeof(limb_t));
+        blocks_.push_back(Block{std::unique_ptr<limb_t[]>(new limb_t[n]), n});
+    }
+
+    limb_t* alloc(size_t n) {
+        if (current_ < blocks_.size() && used_ + n <= blocks_[current_].size) {
+            limb_t* p = blocks_[current_].data.get() + used_;
+            used_ += n;
+            return p;
+        }
+
+        // Не влезло - переходим в следующий блок, при необходимости заводим новый
+        size_t next = blocks_.empty() ? 0 : current_ + 1;
+        if (next >= blocks_.size() || blocks_[next].size < n) {
+            size_t size = std::max(n, blocks_.empty() ? n : 2 * blocks_.back().size);
+            BI_STATS_ALLOC(size * sizeof(limb_t));
+            blocks_.insert(blocks_.begin() + next,
+                           Block{std::unique_ptr<limb_t[]>(new limb_t[size]), size});
+        }
+        current_ = next;
+        used_ = n;
+        return blocks_[current_].data.get();
+    }
+
+private:
+    // Больше этого (в лимбах) между вызовами не держим
+    static constexpr size_t KEEP_LIMIT = size_t(1) << 20;
+
+    void trim() {
+        size_t total = 0;
+        for (const auto& block : blocks_)
+            total += block.size;
+        if (total > KEEP_LIMIT)
+            blocks_.clear();
+    }
+
+    struct Block {
+        std::unique_ptr<limb_t[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_;
+    size_t current_ = 0;    // индекс текущего блока
+    size_t used_ = 0;       // занято в текущем блоке
+};
+
+inline Arena& arena() {
+    thread_local Arena instance;
+    return instance;
+}
+
+// Кадр арены: всё выделенное через него освобождается в деструкторе
+class Frame {
+public:
+    explicit Frame(size_t reserve = 0) : arena_(arena()) {
+        if (reserve)
+            arena_.reserve(reserve);
+        mark_ = arena_.mark();
+    }
+    ~Frame() { arena_.release(mark_); }
+
+    Frame(const Frame&) = delete;
+    Frame& operator=(const Frame&) = delete;
+
+    limb_t* alloc(size_t n) { return arena_.alloc(n); }
+
+private:
+    Arena& arena_;
+    Arena::Mark mark_;
+};
+
+} // namespace scratch
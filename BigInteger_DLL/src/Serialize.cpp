@@ -0,0 +1,299 @@
+#include "../include/BigInteger.h"
+#include "../include/MappedBigInteger.h"
+
+#include <bit>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Ввод и вывод без строк: слова произвольной длины в духе mpz_import/mpz_export
+// и двоичный формат, который можно отображать в память.
+//
+// Формат файла (всё little-endian):
+//   0   8 байт  "BIGINT\0\0"
+//   8   u32     версия (1)
+//   12  u32     флаги, бит 0 - минус
+//   16  u64     число лимбов n (без старших нулей, у нуля 0)
+//   24  u64     зарезервировано, 0
+//   32  n * 8   лимбы, младший первый
+// Лимбы начинаются с 32-го байта, так что в отображённом файле они выровнены.
+
+namespace {
+
+using limb_t = BigInteger::bi_limb_t;
+
+constexpr char MAGIC[8] = {'B', 'I', 'G', 'I', 'N', 'T', '\0', '\0'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 32;
+// Из потока без перемотки лимбы читаем кусками не меньше этого (8 МБ)
+constexpr size_t READ_CHUNK = size_t(1) << 20;
+constexpr bool LITTLE_HOST = std::endian::native == std::endian::little;
+
+struct Header {
+    bool negative;
+    uint64_t size;
+};
+
+uint64_t loadLE(const unsigned char* p, size_t bytes) {
+    uint64_t v = 0;
+    for (size_t i = bytes; i-- > 0;)
+        v = v << 8 | p[i];
+    return v;
+}
+
+void storeLE(unsigned char* p, uint64_t v, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i, v >>= 8)
+        p[i] = static_cast<unsigned char>(v);
+}
+
+void encodeHeader(unsigned char* p, bool negative, uint64_t size) {
+    std::memcpy(p, MAGIC, 8);
+    storeLE(p + 8, VERSION, 4);
+    storeLE(p + 12, negative ? 1 : 0, 4);
+    storeLE(p + 16, size, 8);
+    storeLE(p + 24, 0, 8);
+}
+
+Header decodeHeader(const unsigned char* p) {
+    if (std::memcmp(p, MAGIC, 8) != 0)
+        throw std::runtime_error("not a BigInteger binary file");
+    if (loadLE(p + 8, 4) != VERSION)
+        throw std::runtime_error("unsupported BigInteger binary format version");
+    uint64_t flags = loadLE(p + 12, 4);
+    if (flags > 1)
+        throw std::runtime_error("corrupted BigInteger binary header");
+    return {flags == 1, loadLE(p + 16, 8)};
+}
+
+// Сколько байт осталось в потоке; если он не перематывается - UINT64_MAX
+uint64_t bytesLeft(std::istream& in) {
+    const auto pos = in.tellg();
+    if (pos == std::istream::pos_type(-1))
+        return UINT64_MAX;
+    if (!in.seekg(0, std::ios::end)) {
+        in.clear();
+        return UINT64_MAX;
+    }
+    const auto end = in.tellg();
+    in.seekg(pos);
+    if (end == std::istream::pos_type(-1) || !in)
+        throw std::runtime_error("cannot seek in BigInteger binary stream");
+    return uint64_t(end - pos);
+}
+
+bool littleWords(BigInteger::ByteOrder endian) {
+    return endian == BigInteger::ByteOrder::Little
+        || (endian == BigInteger::ByteOrder::Native && LITTLE_HOST);
+}
+
+} // namespace
+
+BigInteger BigInteger::fromLimbs(std::span<const bi_limb_t> limbs, bool negative) {
+    BigInteger res;
+    if (limbs.empty())
+        return res;
+    res.limbs_.assign(limbs.data(), limbs.data() + limbs.size());
+    res.negative_ = negative;
+    res.normalize();
+    return res;
+}
+
+BigInteger BigInteger::importBytes(std::span<const std::byte> data, size_t wordSize,
+                                   WordOrder order, ByteOrder endian, bool negative) {
+    if (wordSize == 0 || data.size() % wordSize)
+        throw std::invalid_argument("import data is not a whole number of words");
+    const size_t count = data.size() / wordSize;
+    const bool little = littleWords(endian);
+    const auto* src = reinterpret_cast<const unsigned char*>(data.data());
+
+    BigInteger res;
+    if (count == 0)
+        return res;
+
+    if (wordSize == 8 && order == WordOrder::LeastFirst && little && LITTLE_HOST) {
+        // Уже наш формат лимбов
+        res.limbs_.resize(count);
+        std::memcpy(res.limbs_.data(), src, data.size());
+    } else if (wordSize == 8) {
+        res.limbs_.resize(count);
+        for (size_t w = 0; w < count; ++w) {
+            const unsigned char* p = src + 8 * (order == WordOrder::LeastFirst ? w : count - 1 - w);
+            limb_t v;
+            std::memcpy(&v, p, 8);
+            if (little != LITTLE_HOST)
+                v = __builtin_bswap64(v);
+            res.limbs_[w] = v;
+        }
+    } else {
+        // Общий случай: идём по байтам от младшего к старшему, k - номер байта в числе
+        res.limbs_.assign((data.size() + 7) / 8, 0);
+        limb_t* rp = res.limbs_.data();
+        size_t k = 0;
+        for (size_t w = 0; w < count; ++w) {
+            const unsigned char* p = src + wordSize * (order == WordOrder::LeastFirst ? w : count - 1 - w);
+            for (size_t b = 0; b < wordSize; ++b, ++k)
+                rp[k / 8] |= limb_t(p[little ? b : wordSize - 1 - b]) << (8 * (k % 8));
+        }
+    }
+    res.negative_ = negative;
+    res.normalize();
+    return res;
+}
+
+size_t BigInteger::exportSize(size_t wordSize) const {
+    if (wordSize == 0)
+        throw std::invalid_argument("export word size must be positive");
+    const size_t bytes = (bitLength() + 7) / 8;
+    return (bytes + wordSize - 1) / wordSize;
+}
+
+size_t BigInteger::exportBytes(std::span<std::byte> out, size_t wordSize,
+                               WordOrder order, ByteOrder endian) const {
+    const size_t count = exportSize(wordSize);
+    if (out.size() / wordSize < count)
+        throw std::length_error("export buffer is too small");
+    const bool little = littleWords(endian);
+    const size_t n = isZero() ? 0 : limbs_.size();
+    const bi_limb_t* xp = limbs_.data();
+    auto* dst = reinterpret_cast<unsigned char*>(out.data());
+
+    if (wordSize == 8) {
+        for (size_t w = 0; w < count; ++w) {
+            limb_t v = xp[w];
+            if (little != LITTLE_HOST)
+                v = __builtin_bswap64(v);
+            std::memcpy(dst + 8 * (order == WordOrder::LeastFirst ? w : count - 1 - w), &v, 8);
+        }
+        return count;
+    }
+
+    size_t k = 0;
+    for (size_t w = 0; w < count; ++w) {
+        unsigned char* p = dst + wordSize * (order == WordOrder::LeastFirst ? w : count - 1 - w);
+        for (size_t b = 0; b < wordSize; ++b, ++k) {
+            limb_t byte = k / 8 < n ? xp[k / 8] >> (8 * (k % 8)) : 0;
+            p[little ? b : wordSize - 1 - b] = static_cast<unsigned char>(byte);
+        }
+    }
+    return count;
+}
+
+void BigInteger::writeBinary(std::ostream& out) const {
+    const size_t n = isZero() ? 0 : limbs_.size();
+    unsigned char header[HEADER_SIZE];
+    encodeHeader(header, negative_, n);
+    out.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+
+    if constexpr (LITTLE_HOST) {
+        out.write(reinterpret_cast<const char*>(limbs_.data()), std::streamsize(n * 8));
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            unsigned char buf[8];
+            storeLE(buf, limbs_[i], 8);
+            out.write(reinterpret_cast<const char*>(buf), 8);
+        }
+    }
+    if (!out)
+        throw std::runtime_error("failed to write BigInteger binary data");
+}
+
+BigInteger BigInteger::readBinary(std::istream& in) {
+    unsigned char header[HEADER_SIZE];
+    if (!in.read(reinterpret_cast<char*>(header), HEADER_SIZE))
+        throw std::runtime_error("truncated BigInteger binary header");
+    const Header h = decodeHeader(header);
+
+    BigInteger res;
+    if (h.size == 0)
+        return res;
+    if (h.size > SIZE_MAX / 8)
+        throw std::runtime_error("corrupted BigInteger binary header");
+
+    // Размеру из заголовка не верим: испорченный заголовок не должен просить память,
+    // которой нет в потоке. Если поток перематывается, сверяем с остатком, иначе
+    // читаем кусками, удваивая их, - памяти берём не больше чем вдвое против пришедшего
+    const uint64_t left = bytesLeft(in);
+    if (left != UINT64_MAX && left / 8 < h.size)
+        throw std::runtime_error("truncated BigInteger binary data");
+    for (size_t done = 0; done < h.size;) {
+        const size_t chunk = left != UINT64_MAX ? size_t(h.size) : std::max(READ_CHUNK, done);
+        const size_t n = std::min(chunk, size_t(h.size) - done);
+        res.limbs_.resize(done + n);
+        if (!in.read(reinterpret_cast<char*>(res.limbs_.data() + done), std::streamsize(n * 8)))
+            throw std::runtime_error("truncated BigInteger binary data");
+        done += n;
+    }
+    if constexpr (!LITTLE_HOST) {
+        for (size_t i = 0; i < h.size; ++i)
+            res.limbs_[i] = __builtin_bswap64(res.limbs_[i]);
+    }
+    res.negative_ = h.negative;
+    res.normalize();
+    return res;
+}
+
+MappedBigInteger::MappedBigInteger(const std::string& path) {
+    if constexpr (!LITTLE_HOST)
+        throw std::runtime_error("mapped BigInteger files need a little-endian host");
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || size_t(st.st_size) < HEADER_SIZE) {
+        ::close(fd);
+        throw std::runtime_error("not a BigInteger binary file: " + path);
+    }
+    mapSize_ = size_t(st.st_size);
+    map_ = ::mmap(nullptr, mapSize_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        throw std::runtime_error("cannot map " + path);
+    }
+
+    try {
+        const auto* base = static_cast<const unsigned char*>(map_);
+        const Header h = decodeHeader(base);
+        if (h.size != (mapSize_ - HEADER_SIZE) / 8 || (mapSize_ - HEADER_SIZE) % 8)
+            throw std::runtime_error("BigInteger binary file size does not match its header: " + path);
+        limbs_ = reinterpret_cast<const limb_t*>(base + HEADER_SIZE);
+        size_ = h.size;
+        negative_ = h.negative && h.size;
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+MappedBigInteger::~MappedBigInteger() {
+    unmap();
+}
+
+MappedBigInteger::MappedBigInteger(MappedBigInteger&& other) noexcept
+    : map_(std::exchange(other.map_, nullptr)), mapSize_(std::exchange(other.mapSize_, 0))
+    , limbs_(std::exchange(other.limbs_, nullptr)), size_(std::exchange(other.size_, 0))
+    , negative_(std::exchange(other.negative_, false)) {}
+
+MappedBigInteger& MappedBigInteger::operator=(MappedBigInteger&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        map_ = std::exchange(other.map_, nullptr);
+        mapSize_ = std::exchange(other.mapSize_, 0);
+        limbs_ = std::exchange(other.limbs_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        negative_ = std::exchange(other.negative_, false);
+    }
+    return *this;
+}
+
+void MappedBigInteger::unmap() noexcept {
+    if (map_)
+        ::munmap(map_, mapSize_);
+    map_ = nullptr;
+    mapSize_ = 0;
+    limbs_ = nullptr;
+    size_ = 0;
+}
@@ -0,0 +1,116 @@
+#include "Stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// Общие счётчики на все потоки. Порядок между ними не нужен, хватает relaxed
+namespace stats {
+
+namespace {
+
+std::atomic<uint64_t> calls[ALGO_COUNT][SIZE_BUCKETS];
+std::atomic<uint64_t> cycles[ALGO_COUNT];
+std::atomic<uint64_t> allocations;
+std::atomic<uint64_t> allocatedBytes;
+
+#ifdef BIGINTEGER_STATS
+
+thread_local Scope* current = nullptr;
+
+uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+#endif
+
+} // namespace
+
+#ifdef BIGINTEGER_STATS
+
+Scope::Scope(Algo algo, size_t limbs) : algo_(algo), parent_(current) {
+    calls[size_t(algo)][sizeBucket(limbs)].fetch_add(1, std::memory_order_relaxed);
+    current = this;
+    start_ = ticks();
+}
+
+Scope::~Scope() {
+    const uint64_t total = ticks() - start_;
+    cycles[size_t(algo_)].fetch_add(total - std::min(total, nested_), std::memory_order_relaxed);
+    if (parent_)
+        parent_->nested_ += total;
+    current = parent_;
+}
+
+#endif
+
+uint64_t Snapshot::totalCalls(Algo algo) const {
+    uint64_t sum = 0;
+    for (uint64_t c : calls[size_t(algo)])
+        sum += c;
+    return sum;
+}
+
+bool enabled() {
+#ifdef BIGINTEGER_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+Snapshot snapshot() {
+    Snapshot s;
+    for (size_t a = 0; a < ALGO_COUNT; ++a) {
+        for (size_t b = 0; b < SIZE_BUCKETS; ++b)
+            s.calls[a][b] = calls[a][b].load(std::memory_order_relaxed);
+        s.cycles[a] = cycles[a].load(std::memory_order_relaxed);
+    }
+    s.allocations = allocations.load(std::memory_order_relaxed);
+    s.allocatedBytes = allocatedBytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+void reset() {
+    for (size_t a = 0; a < ALGO_COUNT; ++a) {
+        for (size_t b = 0; b < SIZE_BUCKETS; ++b)
+            calls[a][b].store(0, std::memory_order_relaxed);
+        cycles[a].store(0, std::memory_order_relaxed);
+    }
+    allocations.store(0, std::memory_order_relaxed);
+    allocatedBytes.store(0, std::memory_order_relaxed);
+}
+
+const char* name(Algo algo) {
+    static constexpr const char* names[ALGO_COUNT] = {
+        "school_mul", "school_sqr", "karatsuba", "toom3", "toom4", "unbalanced", "ntt",
+        "div_limb", "div_knuth", "div_bz",
+        "lehmer", "hgcd",
+        "redc", "barrett",
+        "parse", "format",
+    };
+    return size_t(algo) < ALGO_COUNT ? names[size_t(algo)] : "unknown";
+}
+
+size_t sizeBucket(size_t limbs) {
+    if (limbs == 0)
+        return 0;
+    return std::min<size_t>(std::bit_width(limbs) - 1, SIZE_BUCKETS - 1);
+}
+
+void countAllocation(size_t bytes) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+} // namespace stats
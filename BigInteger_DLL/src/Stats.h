@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../include/BigIntegerStats.h"
+
+// Точки подсчёта в алгоритмах. Без BIGINTEGER_STATS макросы пустые,
+// аргументы не вычисляются.
+#ifdef BIGINTEGER_STATS
+
+namespace stats {
+
+// Вызов алгоритма: считает его при входе, такты - при выходе
+class Scope {
+public:
+    Scope(Algo algo, size_t limbs);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    Algo algo_;
+    uint64_t start_;
+    uint64_t nested_ = 0;   // такты вложенных Scope, их вычитаем из своих
+    Scope* parent_;
+};
+
+} // namespace stats
+
+#define BI_STATS_SCOPE(algo, limbs) ::stats::Scope biStatsScope_(::stats::Algo::algo, (limbs))
+#define BI_STATS_ALLOC(bytes) ::stats::countAllocation(bytes)
+
+#else
+
+#define BI_STATS_SCOPE(algo, limbs) ((void)0)
+#define BI_STATS_ALLOC(bytes) ((void)0)
+
+#endif
@@ -0,0 +1,336 @@
+// Замеры BigInteger против GMP по размерам операндов от 1 до 10^7 лимбов.
+//
+//   benchmark [--ops add,mul,...] [--min-limbs N] [--max-limbs N] [--min-time SEC]
+//             [--threads N] [--format table|csv|json] [--output FILE]
+//
+// Для каждой операции и размера крутим её, пока не наберётся min-time секунд,
+// и печатаем ns/op, пропускную способность (лимбов операнда в секунду) и во
+// сколько раз мы медленнее GMP (ratio > 1 - мы медленнее). Без --max-limbs
+// деление, НОД и перевод в строки не гоняем на самых больших размерах, см. OPS.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <gmpxx.h>
+#include "BigInteger_DLL/include/BigInteger.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct Options {
+    std::vector<std::string> ops;
+    size_t minLimbs = 1;
+    size_t maxLimbs = 0;            // 0 - свой потолок у каждой операции
+    double minTime = 0.2;
+    unsigned threads = 1;
+    std::string format = "table";
+    std::string output;
+};
+
+struct Result {
+    std::string op;
+    size_t limbs;
+    double ns;          // наше время на операцию
+    double gmpNs;       // время GMP
+    size_t iterations;
+    std::string error;  // непустое, если операция бросила исключение
+};
+
+// Операнды одного замера в обоих представлениях
+struct Operands {
+    BigInteger a, b;
+    mpz_class ma, mb;
+    std::string decimal;
+    unsigned long exp = 0;
+};
+
+std::mt19937_64 rng(2024);
+
+// Случайное число ровно из n лимбов: собираем половинками через сдвиг, O(n log n)
+BigInteger randomLimbs(size_t n) {
+    if (n == 1) {
+        uint64_t limb = rng();
+        return BigInteger(0) + (limb | 1);
+    }
+    size_t low = n / 2;
+    BigInteger res = randomLimbs(n - low) << (64 * low);
+    res |= randomLimbs(low);
+    res.setBit(64 * n - 1);     // старший лимб не нулевой
+    return res;
+}
+
+mpz_class toMpz(const BigInteger& x) {
+    auto limbs = x.get_limbs();
+    mpz_class res;
+    mpz_import(res.get_mpz_t(), limbs.size(), -1, sizeof(limbs[0]), 0, 0, limbs.data());
+    if (x < BigInteger(0))
+        res = -res;
+    return res;
+}
+
+// Сколько секунд заняли iterations вызовов f
+double timeLoop(const std::function<void()>& f, size_t iterations) {
+    auto start = clock_type::now();
+    for (size_t i = 0; i < iterations; ++i)
+        f();
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+// ns на вызов: число повторов удваиваем, пока суммарно не наберём minTime
+std::pair<double, size_t> measure(const std::function<void()>& f, double minTime) {
+    size_t iterations = 1;
+    double t = timeLoop(f, iterations);
+    while (t < minTime) {
+        double scale = t > 0 ? std::min(1.2 * minTime / t, 100.0) : 100.0;
+        iterations = std::max(iterations * 2, static_cast<size_t>(iterations * scale));
+        t = timeLoop(f, iterations);
+    }
+    return {t * 1e9 / iterations, iterations};
+}
+
+struct Op {
+    const char* name;
+    size_t maxLimbs;    // потолок размера, если --max-limbs не задан
+    std::function<void(Operands&, size_t)> prepare;
+    std::function<void(Operands&)> ours;
+    std::function<void(Operands&)> gmp;
+};
+
+// Результаты складываем сюда, чтобы компилятор не выбросил вычисления
+volatile size_t sink;
+
+void sinkValue(const BigInteger& x) { sink = x.get_limbs().size(); }
+void sinkValue(const mpz_class& x) { sink = mpz_size(x.get_mpz_t()); }
+
+void setPair(Operands& o, size_t an, size_t bn) {
+    o.a = randomLimbs(an);
+    o.b = randomLimbs(bn);
+    o.ma = toMpz(o.a);
+    o.mb = toMpz(o.b);
+}
+
+const std::vector<Op> OPS = {
+    {"add", 10000000,
+     [](Operands& o, size_t n) { setPair(o, n, n); },
+     [](Operands& o) { sinkValue(o.a + o.b); },
+     [](Operands& o) { sinkValue(mpz_class(o.ma + o.mb)); }},
+    {"sub", 10000000,
+     [](Operands& o, size_t n) { setPair(o, n, n); },
+     [](Operands& o) { sinkValue(o.a - o.b); },
+     [](Operands& o) { sinkValue(mpz_class(o.ma - o.mb)); }},
+    {"mul", 10000000,
+     [](Operands& o, size_t n) { setPair(o, n, n); },
+     [](Operands& o) { sinkValue(o.a * o.b); },
+     [](Operands& o) { sinkValue(mpz_class(o.ma * o.mb)); }},
+    {"sqr", 10000000,
+     [](Operands& o, size_t n) { setPair(o, n, 1); },
+     [](Operands& o) { sinkValue(o.a * o.a); },
+     [](Operands& o) { sinkValue(mpz_class(o.ma * o.ma)); }},
+    {"div", 1000000,
+     [](Operands& o, size_t n) { setPair(o, 2 * n, n); },
+     [](Operands& o) { sinkValue(o.a / o.b); },
+     [](Operands& o) { sinkValue(mpz_class(o.ma / o.mb)); }},
+    {"mod", 1000000,
+     [](Operands& o, size_t n) { setPair(o, 2 * n, n); },
+     [](Operands& o) { sinkValue(o.a % o.b); },
+     [](Operands& o) { sinkValue(mpz_class(o.ma % o.mb)); }},
+    {"gcd", 100000,
+     [](Operands& o, size_t n) { setPair(o, n, n); },
+     [](Operands& o) { sinkValue(BigInteger::gcd(o.a, o.b)); },
+     [](Operands& o) {
+         mpz_class g;
+         mpz_gcd(g.get_mpz_t(), o.ma.get_mpz_t(), o.mb.get_mpz_t());
+         sinkValue(g);
+     }},
+    // Основание - один случайный лимб, показатель подобран под результат из n лимбов
+    {"pow", 10000000,
+     [](Operands& o, size_t n) {
+         setPair(o, 1, 1);
+         o.exp = static_cast<unsigned long>(n);
+     },
+     [](Operands& o) { sinkValue(o.a.pow(o.exp)); },
+     [](Operands& o) {
+         mpz_class r;
+         mpz_pow_ui(r.get_mpz_t(), o.ma.get_mpz_t(), o.exp);
+         sinkValue(r);
+     }},
+    {"parse", 1000000,
+     [](Operands& o, size_t n) {
+         setPair(o, n, 1);
+         o.decimal = o.ma.get_str();
+     },
+     [](Operands& o) { sinkValue(BigInteger(o.decimal)); },
+     [](Operands& o) { sinkValue(mpz_class(o.decimal)); }},
+    {"to_string", 1000000,
+     [](Operands& o, size_t n) { setPair(o, n, 1); },
+     [](Operands& o) { sink = o.a.toString().size(); },
+     [](Operands& o) { sink = o.ma.get_str().size(); }},
+};
+
+// 1, 2, 5, 10, 20, 50, ... до maxLimbs
+std::vector<size_t> sizes(size_t minLimbs, size_t maxLimbs) {
+    std::vector<size_t> res;
+    for (size_t decade = 1; decade <= maxLimbs; decade *= 10) {
+        for (size_t step : {1, 2, 5}) {
+            size_t n = decade * step;
+            if (n >= minLimbs && n <= maxLimbs)
+                res.push_back(n);
+        }
+        if (decade > maxLimbs / 10)
+            break;
+    }
+    return res;
+}
+
+std::vector<std::string> split(const std::string& s) {
+    std::vector<std::string> res;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find(',', start);
+        if (end == std::string::npos)
+            end = s.size();
+        if (end > start)
+            res.push_back(s.substr(start, end - start));
+        start = end + 1;
+    }
+    return res;
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc)
+                throw std::invalid_argument("missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--ops")
+            opt.ops = split(value());
+        else if (arg == "--min-limbs")
+            opt.minLimbs = std::stoull(value());
+        else if (arg == "--max-limbs")
+            opt.maxLimbs = std::stoull(value());
+        else if (arg == "--min-time")
+            opt.minTime = std::stod(value());
+        else if (arg == "--threads")
+            opt.threads = static_cast<unsigned>(std::stoul(value()));
+        else if (arg == "--format")
+            opt.format = value();
+        else if (arg == "--output")
+            opt.output = value();
+        else
+            return false;
+    }
+    return opt.format == "table" || opt.format == "csv" || opt.format == "json";
+}
+
+double throughput(const Result& r) {
+    return r.ns > 0 ? r.limbs * 1e9 / r.ns : 0;
+}
+
+void printTable(std::ostream& out, const std::vector<Result>& results) {
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-10s %10s %14s %14s %14s %8s\n",
+                  "op", "limbs", "ns/op", "gmp ns/op", "limbs/s", "ratio");
+    out << line;
+    for (const Result& r : results) {
+        if (!r.error.empty()) {
+            std::snprintf(line, sizeof(line), "%-10s %10zu  error: %s\n",
+                          r.op.c_str(), r.limbs, r.error.c_str());
+        } else {
+            std::snprintf(line, sizeof(line), "%-10s %10zu %14.1f %14.1f %14.3g %8.2f\n",
+                          r.op.c_str(), r.limbs, r.ns, r.gmpNs, throughput(r), r.ns / r.gmpNs);
+        }
+        out << line;
+    }
+}
+
+void printCsv(std::ostream& out, const std::vector<Result>& results) {
+    out << "op,limbs,iterations,ns_per_op,gmp_ns_per_op,limbs_per_sec,ratio,error\n";
+    for (const Result& r : results) {
+        out << r.op << ',' << r.limbs << ',' << r.iterations << ',' << r.ns << ','
+            << r.gmpNs << ',' << throughput(r) << ',' << (r.error.empty() ? r.ns / r.gmpNs : 0)
+            << ',' << r.error << '\n';
+    }
+}
+
+void printJson(std::ostream& out, const std::vector<Result>& results, const Options& opt) {
+    out << "{\n  \"min_time\": " << opt.minTime << ",\n  \"threads\": " << opt.threads
+        << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "    {\"op\": \"" << r.op << "\", \"limbs\": " << r.limbs;
+        if (!r.error.empty()) {
+            out << ", \"error\": \"" << r.error << "\"}";
+        } else {
+            out << ", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << r.ns
+                << ", \"gmp_ns_per_op\": " << r.gmpNs << ", \"limbs_per_sec\": " << throughput(r)
+                << ", \"ratio\": " << r.ns / r.gmpNs << "}";
+        }
+        out << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    try {
+        if (!parseArgs(argc, argv, opt)) {
+            std::cerr << "usage: benchmark [--ops add,sub,mul,sqr,div,mod,gcd,pow,parse,to_string]\n"
+                         "                 [--min-limbs N] [--max-limbs N] [--min-time SEC]\n"
+                         "                 [--threads N] [--format table|csv|json] [--output FILE]\n";
+            return 2;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 2;
+    }
+    BigInteger::setThreadCount(opt.threads);
+
+    std::vector<Result> results;
+    for (const Op& op : OPS) {
+        if (!opt.ops.empty() && std::find(opt.ops.begin(), opt.ops.end(), op.name) == opt.ops.end())
+            continue;
+        for (size_t n : sizes(opt.minLimbs, opt.maxLimbs ? opt.maxLimbs : op.maxLimbs)) {
+            Result r{op.name, n, 0, 0, 0, ""};
+            try {
+                Operands o;
+                op.prepare(o, n);
+                auto [ns, iterations] = measure([&] { op.ours(o); }, opt.minTime);
+                r.ns = ns;
+                r.iterations = iterations;
+                r.gmpNs = measure([&] { op.gmp(o); }, opt.minTime).first;
+            } catch (const std::exception& e) {
+                r.error = e.what();
+            }
+            results.push_back(r);
+            std::cerr << op.name << ' ' << n << " limbs done\n";     // ход работы
+        }
+    }
+
+    std::ofstream file;
+    if (!opt.output.empty()) {
+        file.open(opt.output);
+        if (!file) {
+            std::cerr << "cannot open " << opt.output << '\n';
+            return 1;
+        }
+    }
+    std::ostream& out = opt.output.empty() ? std::cout : file;
+    if (opt.format == "csv")
+        printCsv(out, results);
+    else if (opt.format == "json")
+        printJson(out, results, opt);
+    else
+        printTable(out, results);
+    return 0;
+}
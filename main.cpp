@@ -2,13 +2,30 @@
 #include <gmpxx.h>
 #include <iomanip>  // для hex-формата
 #include <chrono>
+#include <sstream>
 #include "BigInteger_DLL/include/BigInteger.h"
+#include "BigInteger_DLL/include/MontgomeryContext.h"
+#include "BigInteger_DLL/include/BigIntegerStats.h"
+#include "BigInteger_DLL/include/MappedBigInteger.h"
+#include "BigInteger_DLL/include/FixedBigInteger.h"
+#include <cstdio>
+#include <fstream>
 
 template <typename T>
 class test {
     test(T t) = delete;
 };
 
+// Для test 30: ленивое произведение не принимает временные множители
+template <typename T>
+concept LazyAccepts = requires(T&& x) { BigInteger::lazy(std::forward<T>(x)); };
+template <typename T>
+concept LazyTimesAccepts = requires(T&& x, const BigInteger& a) { BigInteger::lazy(a) * std::forward<T>(x); };
+
+// Для test 35: разбирается ли литерал _fbi из этих символов во время компиляции
+template <char... Chars>
+concept FbiDigits = requires { typename std::integral_constant<size_t, fixed_literal::parse<Chars...>().size>; };
+
 
 bool equal(mpz_class mpz_a, BigInteger bi_b) {
     // Получаем "сырые" данные из mpz
@@ -210,6 +227,653 @@ int main() {
         std::cout << (b1 != b2 ? "Test 13 passed\n" : "Test 13 failed\n");
     }
 
+    // test 15 умножение больших чисел (NTT)
+    {
+        mpz_class a, b;
+        mpz_ui_pow_ui(a.get_mpz_t(), 3, 200000);
+        mpz_ui_pow_ui(b.get_mpz_t(), 7, 150000);
+        mpz_class mpz_result = a * b;
+
+        BigInteger bi_a = (3_bi).pow(200000);
+        BigInteger bi_b = (7_bi).pow(150000);
+        BigInteger bi_result = bi_a * bi_b;
+
+        std::cout << (equal(a, bi_a) && equal(b, bi_b) && equal(mpz_result, bi_result)
+                      ? "Test 15 passed\n" : "Test 15 failed\n");
+    }
+
+    // test 16 умножение чисел средней длины (Toom-3 / Toom-4), в том числе отрицательных
+    {
+        mpz_class a, b;
+        mpz_ui_pow_ui(a.get_mpz_t(), 3, 40000);
+        mpz_ui_pow_ui(b.get_mpz_t(), 5, 30000);
+        a = -a;
+        mpz_class mpz_result = a * b;
+
+        BigInteger bi_a = 0_bi - (3_bi).pow(40000);
+        BigInteger bi_b = (5_bi).pow(30000);
+        BigInteger bi_result = bi_a * bi_b;
+
+        std::cout << (equal(mpz_result, bi_result) ? "Test 16 passed\n" : "Test 16 failed\n");
+    }
+
+    // test 17 деление и остаток больших чисел (Кнут и Burnikel-Ziegler)
+    {
+        mpz_class a, b;
+        mpz_ui_pow_ui(a.get_mpz_t(), 3, 200000);
+        mpz_ui_pow_ui(b.get_mpz_t(), 7, 40000);
+        a = -a;
+        mpz_class mpz_q, mpz_r;
+        mpz_tdiv_qr(mpz_q.get_mpz_t(), mpz_r.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+
+        BigInteger bi_a = 0_bi - (3_bi).pow(200000);
+        BigInteger bi_b = (7_bi).pow(40000);
+        BigInteger bi_q = bi_a / bi_b;
+        BigInteger bi_r = bi_a % bi_b;
+
+        std::cout << (equal(mpz_q, bi_q) && equal(mpz_r, bi_r) ? "Test 17 passed\n" : "Test 17 failed\n");
+    }
+
+    // test 18 разбор длинной десятичной строки и from_chars
+    {
+        std::string digits = "-";
+        for (int i = 0; i < 50000; ++i)
+            digits += static_cast<char>('0' + (i * 7 + i / 13) % 10);
+
+        mpz_class mpz_result(digits, 10);
+        BigInteger bi_result(digits);
+
+        BigInteger bi_chars;
+        std::string tail = digits + "xyz";
+        auto [ptr, ec] = from_chars(tail.data(), tail.data() + tail.size(), bi_chars);
+
+        std::cout << (equal(mpz_result, bi_result) && equal(mpz_result, bi_chars)
+                      && ec == std::errc() && ptr == tail.data() + digits.size()
+                      ? "Test 18 passed\n" : "Test 18 failed\n");
+    }
+
+    // test 19 вывод в десятичной и других системах, to_chars
+    {
+        mpz_class a;
+        mpz_ui_pow_ui(a.get_mpz_t(), 3, 100000);
+        a = -a;
+        BigInteger bi_a = 0_bi - (3_bi).pow(100000);
+
+        std::ostringstream dec, hex;
+        dec << bi_a;
+        hex << std::hex << bi_a;
+
+        std::string buffer(a.get_str().size(), ' ');
+        auto [ptr, ec] = to_chars(buffer.data(), buffer.data() + buffer.size(), bi_a);
+
+        std::cout << (dec.str() == a.get_str() && hex.str() == a.get_str(16)
+                      && bi_a.toString(36) == a.get_str(36)
+                      && ec == std::errc() && buffer == a.get_str()
+                      ? "Test 19 passed\n" : "Test 19 failed\n");
+    }
+
+    // test 20 накопление через += / -= и операции с временными объектами
+    {
+        mpz_class mpz_sum = 0, mpz_term("123456789012345678901234567890123456789");
+        BigInteger bi_sum = 0, bi_term("123456789012345678901234567890123456789");
+        for (int i = 0; i < 1000; ++i) {
+            if (i % 3 == 2) {
+                mpz_sum -= mpz_term * 5;
+                bi_sum -= bi_term * 5_bi;
+            } else {
+                mpz_sum += mpz_term;
+                bi_sum += bi_term;
+            }
+        }
+        mpz_class mpz_result = (mpz_sum - mpz_term) * mpz_term + (mpz_term - mpz_sum * 2);
+        BigInteger bi_result = (bi_sum - bi_term) * bi_term + (bi_term - bi_sum * 2_bi);
+
+        std::cout << (equal(mpz_sum, bi_sum) && equal(mpz_result, bi_result)
+                      ? "Test 20 passed\n" : "Test 20 failed\n");
+    }
+
+    // test 21 маленькие числа во встроенном буфере: копии, перемещения, рост и сжатие
+    {
+        std::vector<mpz_class> mpz_fib{0, 1};
+        std::vector<BigInteger> bi_fib{0_bi, 1_bi};
+        for (int i = 2; i < 300; ++i) {
+            mpz_fib.push_back(mpz_fib[i - 1] + mpz_fib[i - 2]);
+            bi_fib.push_back(bi_fib[i - 1] + bi_fib[i - 2]);
+        }
+
+        // Большое минус почти такое же - результат снова помещается в лимб
+        BigInteger bi_small = bi_fib[299] - bi_fib[298] - bi_fib[297];
+        BigInteger bi_copy = bi_fib[150];
+        bi_copy = bi_fib[10];
+        BigInteger bi_min(LLONG_MIN);
+
+        bool ok = bi_small == 0_bi && bi_copy == 55_bi
+                  && equal(mpz_class(std::to_string(LLONG_MIN)), bi_min);
+        for (int i = 1; i < 300; ++i)     // ноль у GMP без лимбов, его не сравниваем
+            ok = ok && equal(mpz_fib[i], bi_fib[i]);
+
+        std::cout << (ok ? "Test 21 passed\n" : "Test 21 failed\n");
+    }
+
+    // test 22 умножение и деление чисел из одних единичных бит (переносы через все лимбы)
+    {
+        mpz_class a, b;
+        mpz_ui_pow_ui(a.get_mpz_t(), 2, 64 * 700);
+        mpz_ui_pow_ui(b.get_mpz_t(), 2, 64 * 450);
+        a -= 1;
+        b -= 1;
+        mpz_class mpz_result = a * b;
+        mpz_class mpz_quotient = (mpz_result + a) / b;
+
+        BigInteger bi_a = (2_bi).pow(64 * 700) - 1_bi;
+        BigInteger bi_b = (2_bi).pow(64 * 450) - 1_bi;
+        BigInteger bi_result = bi_a * bi_b;
+        BigInteger bi_quotient = (bi_result + bi_a) / bi_b;
+
+        std::cout << (equal(mpz_result, bi_result) && equal(mpz_quotient, bi_quotient)
+                      ? "Test 22 passed\n" : "Test 22 failed\n");
+    }
+
+    // test 23 возведение в квадрат через x * x и x *= x на всех уровнях алгоритмов
+    {
+        bool ok = true;
+        for (unsigned long exp : {500ul, 2500ul, 9000ul, 30000ul, 400000ul}) {
+            mpz_class a;
+            mpz_ui_pow_ui(a.get_mpz_t(), 3, exp);
+            mpz_class mpz_result = a * a;
+
+            BigInteger bi_a = (3_bi).pow(exp);
+            BigInteger bi_result = bi_a * bi_a;
+            BigInteger bi_inplace = bi_a;
+            bi_inplace *= bi_inplace;
+            ok = ok && equal(mpz_result, bi_result) && equal(mpz_result, bi_inplace);
+        }
+        std::cout << (ok ? "Test 23 passed\n" : "Test 23 failed\n");
+    }
+
+    // test 24 параллельное умножение (Toom и NTT) совпадает с последовательным
+    {
+        BigInteger::setThreadCount(4);
+        bool ok = true;
+        for (unsigned long exp : {60000ul, 1500000ul}) {
+            mpz_class a, b;
+            mpz_ui_pow_ui(a.get_mpz_t(), 3, exp);
+            mpz_ui_pow_ui(b.get_mpz_t(), 7, exp / 2);
+            mpz_class mpz_result = a * b;
+            mpz_class mpz_square = a * a;
+
+            BigInteger bi_a = (3_bi).pow(exp);
+            BigInteger bi_b = (7_bi).pow(exp / 2);
+            ok = ok && equal(mpz_result, bi_a * bi_b) && equal(mpz_square, bi_a * bi_a);
+        }
+        BigInteger::setThreadCount(1);
+        std::cout << (ok ? "Test 24 passed\n" : "Test 24 failed\n");
+    }
+
+    // test 25 модульное возведение в степень: нечётный модуль (Монтгомери) и чётный (Барретт)
+    {
+        mpz_class mpz_base, mpz_exp, mpz_odd, mpz_even;
+        mpz_ui_pow_ui(mpz_base.get_mpz_t(), 3, 5000);
+        mpz_ui_pow_ui(mpz_exp.get_mpz_t(), 7, 700);
+        mpz_ui_pow_ui(mpz_odd.get_mpz_t(), 5, 1300);
+        mpz_odd += 2;
+        mpz_even = mpz_odd + 1;
+        mpz_class mpz_pow_odd, mpz_pow_even;
+        mpz_powm(mpz_pow_odd.get_mpz_t(), mpz_base.get_mpz_t(), mpz_exp.get_mpz_t(), mpz_odd.get_mpz_t());
+        mpz_powm(mpz_pow_even.get_mpz_t(), mpz_base.get_mpz_t(), mpz_exp.get_mpz_t(), mpz_even.get_mpz_t());
+        mpz_class mpz_mul = (-mpz_base * mpz_exp) % mpz_odd + mpz_odd;
+
+        BigInteger bi_base = (3_bi).pow(5000);
+        BigInteger bi_exp = (7_bi).pow(700);
+        BigInteger bi_odd = (5_bi).pow(1300) + 2_bi;
+        MontgomeryContext odd(bi_odd);
+        MontgomeryContext even(bi_odd + 1_bi);
+
+        bool ok = odd.isMontgomery() && !even.isMontgomery()
+               && equal(mpz_pow_odd, odd.modPow(bi_base, bi_exp))
+               && equal(mpz_pow_even, even.modPow(bi_base, bi_exp))
+               && equal(mpz_pow_odd, bi_base.modPow(bi_exp, bi_odd))
+               && equal(mpz_mul, odd.mulmod(BigInteger(0) - bi_base, bi_exp));
+        std::cout << (ok ? "Test 25 passed\n" : "Test 25 failed\n");
+    }
+
+    // test 26 НОД, коэффициенты Безу и обратный по модулю (Лемер и half-GCD)
+    {
+        mpz_class a, b, c;
+        mpz_ui_pow_ui(a.get_mpz_t(), 3, 400000);
+        mpz_ui_pow_ui(b.get_mpz_t(), 7, 250000);
+        mpz_ui_pow_ui(c.get_mpz_t(), 11, 30000);
+        a = a * c + 1;
+        b = -(b * c + c);
+        mpz_class mpz_gcd_ab, mpz_inverse;
+        mpz_gcd(mpz_gcd_ab.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        mpz_class m = b / mpz_gcd_ab;
+        mpz_invert(mpz_inverse.get_mpz_t(), a.get_mpz_t(), m.get_mpz_t());
+
+        BigInteger bi_c = (11_bi).pow(30000);
+        BigInteger bi_a = (3_bi).pow(400000) * bi_c + 1_bi;
+        BigInteger bi_b = 0_bi - ((7_bi).pow(250000) * bi_c + bi_c);
+        auto [g, x, y] = BigInteger::extendedGCD(bi_a, bi_b);
+        mpz_class bezout = a * mpz_class(x.toString()) + b * mpz_class(y.toString());
+        BigInteger bi_m = bi_b / g;
+
+        bool ok = equal(mpz_gcd_ab, BigInteger::gcd(bi_a, bi_b)) && equal(mpz_gcd_ab, g)
+               && bezout == mpz_gcd_ab
+               && equal(mpz_inverse, bi_a.modInverse(0_bi - bi_m));
+        std::cout << (ok ? "Test 26 passed\n" : "Test 26 failed\n");
+    }
+
+    // test 27 операции со скалярами (int64_t, uint64_t) без временных BigInteger
+    {
+        const long min64 = LLONG_MIN;
+        const unsigned long max64 = ULLONG_MAX;
+        mpz_class a;
+        mpz_ui_pow_ui(a.get_mpz_t(), 3, 1000);
+        a = -a;
+        mpz_class mpz_chain = a * min64 + max64;
+        mpz_chain = mpz_chain - 12345;
+        mpz_class mpz_rest = a % 1000000007;           // знак как у делимого
+        mpz_class mpz_quot = a / min64;
+        mpz_class mpz_rev = 7 - a;
+        mpz_class mpz_mul = a * max64;
+
+        BigInteger bi_a = 0_bi - (3_bi).pow(1000);
+        BigInteger bi_chain = bi_a * int64_t(min64) + uint64_t(max64);
+        bi_chain -= 12345;
+
+        bool threw = false;
+        try {
+            bi_a / 0;
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+
+        BigInteger hash = 1;
+        mpz_class mpz_hash = 1;
+        for (int i = 0; i < 100000; ++i) {
+            hash = (hash * 31 + i) % 1000000007ULL;
+            mpz_hash = (mpz_hash * 31 + i) % 1000000007UL;
+        }
+
+        bool ok = equal(mpz_chain, bi_chain)
+               && equal(mpz_rest, bi_a % 1000000007)
+               && equal(mpz_quot, bi_a / int64_t(min64))
+               && equal(mpz_rev, 7 - bi_a)
+               && equal(mpz_mul, bi_a * uint64_t(max64))
+               && equal(mpz_hash, hash) && threw;
+        std::cout << (ok ? "Test 27 passed\n" : "Test 27 failed\n");
+    }
+
+    // test 28 сдвиги и побитовые операции (отрицательные - дополнительный код, как в GMP)
+    {
+        mpz_class a, b;
+        mpz_ui_pow_ui(a.get_mpz_t(), 3, 5000);
+        mpz_ui_pow_ui(b.get_mpz_t(), 7, 2000);
+        b = -b;
+        mpz_class mpz_shl, mpz_shr, mpz_and_ab, mpz_or_ab, mpz_xor_ab, mpz_not = ~b;
+        mpz_mul_2exp(mpz_shl.get_mpz_t(), b.get_mpz_t(), 1000);
+        mpz_fdiv_q_2exp(mpz_shr.get_mpz_t(), b.get_mpz_t(), 777);
+        mpz_and(mpz_and_ab.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        mpz_ior(mpz_or_ab.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        mpz_xor(mpz_xor_ab.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        mpz_class mpz_low = a;
+        mpz_fdiv_r_2exp(mpz_low.get_mpz_t(), a.get_mpz_t(), 4000);
+        mpz_class mpz_mersenne = 1;
+        mpz_mul_2exp(mpz_mersenne.get_mpz_t(), mpz_mersenne.get_mpz_t(), 1000003);
+        mpz_mersenne -= 1;
+
+        BigInteger bi_a = (3_bi).pow(5000);
+        BigInteger bi_b = 0_bi - (7_bi).pow(2000);
+        BigInteger bi_set = bi_b;
+        bi_set.setBit(3000);
+        bi_set.setBit(5, false);
+        mpz_class mpz_set = b;
+        mpz_setbit(mpz_set.get_mpz_t(), 3000);
+        mpz_clrbit(mpz_set.get_mpz_t(), 5);
+
+        bool bits_ok = true;
+        for (size_t i = 0; i < 6000; i += 7)
+            bits_ok &= bi_b.testBit(i) == (mpz_tstbit(b.get_mpz_t(), i) != 0);
+
+        bool ok = equal(mpz_shl, bi_b << 1000) && equal(mpz_shr, bi_b >> 777)
+               && equal(mpz_and_ab, bi_a & bi_b) && equal(mpz_or_ab, bi_a | bi_b)
+               && equal(mpz_xor_ab, bi_a ^ bi_b) && equal(mpz_not, ~bi_b)
+               && equal(mpz_low, bi_a & ((1_bi << 4000) - 1_bi))
+               && equal(mpz_mersenne, (1_bi << 1000003) - 1_bi) && (1_bi << 1000003) == (2_bi).pow(1000003)
+               && equal(mpz_set, bi_set) && bits_ok
+               && bi_a.bitLength() == mpz_sizeinbase(a.get_mpz_t(), 2)
+               && bi_a.popcount() == mpz_popcount(a.get_mpz_t())
+               && (bi_b << 1000).trailingZeros() == mpz_scan1(mpz_shl.get_mpz_t(), 0)
+               && bi_set.trailingZeros() == mpz_scan1(mpz_set.get_mpz_t(), 0) && (0_bi).trailingZeros() == 0;
+        std::cout << (ok ? "Test 28 passed\n" : "Test 28 failed\n");
+    }
+
+    // test 29 pow: отрицательное основание, множитель 2^k у основания, степень двойки
+    {
+        mpz_class base("-340282366920938463463374607431768211456000"), mpz_odd, mpz_even, mpz_two;
+        mpz_pow_ui(mpz_odd.get_mpz_t(), base.get_mpz_t(), 12345);
+        mpz_pow_ui(mpz_even.get_mpz_t(), base.get_mpz_t(), 1000);
+        mpz_ui_pow_ui(mpz_two.get_mpz_t(), 2, 1000003);
+
+        BigInteger bi_base("-340282366920938463463374607431768211456000");
+        bool ok = equal(mpz_odd, bi_base.pow(12345)) && equal(mpz_even, bi_base.pow(1000))
+               && equal(mpz_two, (2_bi).pow(1000003)) && equal(1, bi_base.pow(0))
+               && equal(-1, BigInteger(-1).pow(7));
+        std::cout << (ok ? "Test 29 passed\n" : "Test 29 failed\n");
+    }
+
+    // test 30 совмещённые выражения с ленивым произведением: c - lazy(a) * b, (lazy(a) * b) % m, ...
+    // обычный a * b - сразу BigInteger: копия не смотрит на множители, методы вызываются на месте
+    {
+        mpz_class a, b, c, m;
+        mpz_ui_pow_ui(a.get_mpz_t(), 3, 3000);
+        mpz_ui_pow_ui(b.get_mpz_t(), 7, 1000);
+        mpz_ui_pow_ui(c.get_mpz_t(), 5, 4000);
+        mpz_ui_pow_ui(m.get_mpz_t(), 11, 500);
+        b = -b;
+        mpz_class mpz_sub = c - a * b;
+        mpz_class mpz_sum = a * b + c * a;
+        mpz_class mpz_rem = (a * b) % m;
+        mpz_class mpz_acc = c;
+        mpz_acc -= c * c;
+        mpz_acc += a * 12345;
+        mpz_class mpz_sq = a * b * a * b;
+
+        BigInteger bi_a = (3_bi).pow(3000);
+        BigInteger bi_b = 0_bi - (7_bi).pow(1000);
+        BigInteger bi_c = (5_bi).pow(4000);
+        BigInteger bi_m = (11_bi).pow(500);
+        BigInteger bi_k = 12345;
+        BigInteger bi_acc = bi_c;
+        bi_acc -= BigInteger::lazy(bi_c) * bi_c;
+        bi_acc += BigInteger::lazy(bi_a) * bi_k;
+        BigInteger bi_prod;
+        bi_prod = BigInteger::lazy(bi_a) * bi_b;
+
+        BigInteger bi_x = bi_a;
+        auto eager = bi_x * bi_b;
+        bi_x = 5;
+
+        bool ok = equal(mpz_sub, bi_c - BigInteger::lazy(bi_a) * bi_b)
+               && equal(mpz_sum, BigInteger::lazy(bi_a) * bi_b + BigInteger::lazy(bi_c) * bi_a)
+               && equal(mpz_rem, (BigInteger::lazy(bi_a) * bi_b) % bi_m) && equal(mpz_acc, bi_acc)
+               && equal(a * b, bi_prod) && equal(mpz_sub, bi_c - bi_a * bi_b) && equal(mpz_rem, (bi_a * bi_b) % bi_m)
+               && equal(a * b, eager) && equal(mpz_sq, (bi_a * bi_b).pow(2)) && equal(-(a * b), 0_bi - bi_a * bi_b);
+        // lazy(BigInteger(1)) и lazy(a) * (b + c) не компилируются, именованный узел не подставить
+        static_assert(LazyAccepts<BigInteger&> && !LazyAccepts<BigInteger> && !LazyAccepts<const BigInteger>);
+        static_assert(LazyTimesAccepts<const BigInteger&> && !LazyTimesAccepts<BigInteger>);
+        static_assert(std::is_convertible_v<BigInteger::MulExpr, BigInteger>
+                      && !std::is_convertible_v<BigInteger::MulExpr&, BigInteger>);
+        std::cout << (ok ? "Test 30 passed\n" : "Test 30 failed\n");
+    }
+
+    // test 31 счётчики: Карацуба на 100 лимбах попадает в корзину [64, 128), без опции всё по нулям
+    {
+        mpz_class a, mpz_prod;
+        mpz_ui_pow_ui(a.get_mpz_t(), 3, 4000);
+        mpz_prod = a * (a + 1);
+
+        BigInteger bi_a = (3_bi).pow(4000);
+        stats::reset();
+        BigInteger bi_prod = bi_a * (bi_a + 1_bi);
+        stats::Snapshot s = stats::snapshot();
+
+        bool ok = equal(mpz_prod, bi_prod) && std::string(stats::name(stats::Algo::Karatsuba)) == "karatsuba";
+        if (stats::enabled())
+            ok = ok && s.calls[size_t(stats::Algo::Karatsuba)][6] == 1 && s.cycles[size_t(stats::Algo::Karatsuba)] > 0
+                    && s.totalCalls(stats::Algo::SchoolMul) > 0 && s.allocations > 0;
+        else
+            ok = ok && s.totalCalls(stats::Algo::Karatsuba) == 0 && s.allocations == 0;
+        stats::reset();
+        ok = ok && stats::snapshot().totalCalls(stats::Algo::Karatsuba) == 0;
+        std::cout << (ok ? "Test 31 passed\n" : "Test 31 failed\n");
+    }
+
+    // test 32 импорт/экспорт слов как mpz_import/mpz_export и двоичный файл через mmap
+    {
+        mpz_class a;
+        mpz_ui_pow_ui(a.get_mpz_t(), 7, 2000);
+        a = -a;
+        BigInteger bi_a = 0_bi - (7_bi).pow(2000);
+
+        bool ok = true;
+        for (size_t size : {1, 3, 4, 8, 16}) {
+            for (int order : {-1, 1}) {
+                for (int endian : {-1, 1}) {
+                    auto bi_order = order < 0 ? BigInteger::WordOrder::LeastFirst : BigInteger::WordOrder::MostFirst;
+                    auto bi_endian = endian < 0 ? BigInteger::ByteOrder::Little : BigInteger::ByteOrder::Big;
+
+                    size_t count = 0;
+                    std::vector<std::byte> gmp_buf(bi_a.exportSize(size) * size);
+                    mpz_export(gmp_buf.data(), &count, order, size, endian, 0, a.get_mpz_t());
+                    std::vector<std::byte> bi_buf(bi_a.exportSize(size) * size);
+                    ok = ok && bi_a.exportBytes(bi_buf, size, bi_order, bi_endian) == count && bi_buf == gmp_buf;
+
+                    mpz_class back;
+                    mpz_import(back.get_mpz_t(), count, order, size, endian, 0, gmp_buf.data());
+                    ok = ok && equal(-back, BigInteger::importBytes(gmp_buf, size, bi_order, bi_endian, true));
+                }
+            }
+        }
+        ok = ok && equal(a, BigInteger::fromLimbs(bi_a.get_limbs(), true))
+                && BigInteger(0).exportSize(4) == 0;
+
+        const char* path = "bigint_test32.bin";
+        {
+            std::ofstream file(path, std::ios::binary);
+            bi_a.writeBinary(file);
+        }
+        {
+            std::ifstream file(path, std::ios::binary);
+            ok = ok && equal(a, BigInteger::readBinary(file));
+        }
+        {
+            MappedBigInteger mapped(path);
+            ok = ok && mapped.isNegative() && mapped.limbs().size() == bi_a.get_limbs().size()
+                    && std::equal(mapped.limbs().begin(), mapped.limbs().end(), bi_a.get_limbs().begin())
+                    && equal(a, mapped.toBigInteger());
+        }
+        std::remove(path);
+
+        // Заголовок с испорченной длиной (2^40 лимбов) не должен выделять память под неё:
+        // ни в обычном потоке, ни в потоке без перемотки
+        struct NoSeekBuf : std::stringbuf {
+            using std::stringbuf::stringbuf;
+            pos_type seekoff(off_type, std::ios::seekdir, std::ios::openmode) override { return pos_type(-1); }
+            pos_type seekpos(pos_type, std::ios::openmode) override { return pos_type(-1); }
+        };
+        std::ostringstream out;
+        bi_a.writeBinary(out);
+        std::string corrupted = out.str();
+        corrupted[16 + 5] = 1;
+        auto rejects = [](std::istream& in) {
+            try {
+                BigInteger::readBinary(in);
+            } catch (const std::runtime_error&) {
+                return true;
+            }
+            return false;
+        };
+        std::istringstream seekable(corrupted);
+        NoSeekBuf buf(corrupted);
+        std::istream unseekable(&buf);
+        NoSeekBuf good_buf(out.str());
+        std::istream good(&good_buf);
+        ok = ok && rejects(seekable) && rejects(unseekable) && equal(a, BigInteger::readBinary(good));
+        std::cout << (ok ? "Test 32 passed\n" : "Test 32 failed\n");
+    }
+
+    // test 33 виды: куски чужого буфера, смешанная арифметика с BigInteger, сравнения
+    {
+        mpz_class a, b, lo, hi;
+        mpz_ui_pow_ui(a.get_mpz_t(), 3, 20000);
+        mpz_ui_pow_ui(b.get_mpz_t(), 5, 3000);
+        mpz_tdiv_r_2exp(lo.get_mpz_t(), a.get_mpz_t(), 64 * 100);
+        mpz_tdiv_q_2exp(hi.get_mpz_t(), a.get_mpz_t(), 64 * 100);
+
+        BigInteger bi_a = (3_bi).pow(20000);
+        BigInteger bi_b = (5_bi).pow(3000);
+        std::vector<uint64_t> buffer(bi_b.get_limbs().begin(), bi_b.get_limbs().end());
+        buffer.resize(buffer.size() + 3, 0);    // старшие нули обрезаются
+        BigIntegerView va = bi_a;
+        BigIntegerView vb(buffer.data(), buffer.size(), true);
+        BigIntegerView vlo = va.slice(0, 100), vhi = va.slice(100, SIZE_MAX);
+
+        BigInteger bi_q = va / vb, bi_r = bi_a % vb;
+        BigInteger bi_acc = bi_a;
+        bi_acc -= vb;
+        bi_acc *= vlo;
+        bool ok = equal(lo, BigInteger(vlo)) && equal(hi, BigInteger(vhi))
+               && equal(a - b, va + vb) && equal(a + b, bi_a - vb) && equal(-a * b, vb * bi_a)
+               && equal(lo * hi, vlo * vhi) && equal(a / -b, bi_q) && equal(a % -b, bi_r)
+               && equal((a + b) * lo, bi_acc)
+               && vb < va && vb < 0_bi && va == bi_a && va.slice(500, 10).isZero()
+               && BigIntegerView() == BigIntegerView(buffer.data() + buffer.size() - 3, 3, true);
+        std::cout << (ok ? "Test 33 passed\n" : "Test 33 failed\n");
+    }
+
+    // test 34 пакетные операции: произведение и сумма многих чисел, дерево остатков, n! и C(n, k)
+    {
+        std::vector<mpz_class> values, moduli;
+        std::vector<BigInteger> bi_values, bi_moduli;
+        mpz_class mpz_prod = 1, mpz_sum = 0, x;
+        for (int i = 0; i < 1000; ++i) {
+            mpz_class v;
+            mpz_ui_pow_ui(v.get_mpz_t(), 3 + i % 7, 50 + i % 13 * 40);
+            if (i % 5 == 0)
+                v = -v;
+            values.push_back(v);
+            mpz_prod *= v;
+            mpz_sum += v;
+
+            BigInteger bi_v = BigInteger(3 + i % 7).pow(50 + i % 13 * 40);
+            bi_values.push_back(i % 5 == 0 ? 0_bi - bi_v : bi_v);
+        }
+        for (int i = 0; i < 300; ++i) {
+            mpz_class m;
+            mpz_ui_pow_ui(m.get_mpz_t(), 1000003 + 2 * i, 1 + i % 9);
+            moduli.push_back(i % 3 ? m : -m);
+            BigInteger bi_m = BigInteger(1000003 + 2 * i).pow(1 + i % 9);
+            bi_moduli.push_back(i % 3 ? bi_m : 0_bi - bi_m);
+        }
+        mpz_ui_pow_ui(x.get_mpz_t(), 17, 30000);
+        x = -x;
+        BigInteger bi_x = 0_bi - (17_bi).pow(30000);
+
+        bool ok = equal(mpz_prod, BigInteger::product(bi_values)) && equal(mpz_sum, BigInteger::sum(bi_values))
+               && equal(1, BigInteger::product({})) && BigInteger::sum({}) == 0_bi;
+        std::vector<BigInteger> rems = BigInteger::remainders(bi_x, bi_moduli);
+        ok = ok && rems.size() == moduli.size();
+        for (size_t i = 0; ok && i < moduli.size(); ++i) {
+            mpz_class r;
+            mpz_tdiv_r(r.get_mpz_t(), x.get_mpz_t(), moduli[i].get_mpz_t());
+            ok = equal(r, rems[i]);
+        }
+
+        mpz_class fac, fac0, binom, binom_big;
+        mpz_fac_ui(fac.get_mpz_t(), 20000);
+        mpz_fac_ui(fac0.get_mpz_t(), 0);
+        mpz_bin_uiui(binom.get_mpz_t(), 1000, 300);
+        mpz_bin_uiui(binom_big.get_mpz_t(), 100000, 49999);
+        ok = ok && equal(fac, BigInteger::factorial(20000)) && equal(fac0, BigInteger::factorial(0))
+                && equal(binom, BigInteger::binomial(1000, 300)) && equal(binom_big, BigInteger::binomial(100000, 49999))
+                && BigInteger::binomial(5, 7) == 0_bi && equal(1, BigInteger::binomial(7, 7));
+        std::cout << (ok ? "Test 34 passed\n" : "Test 34 failed\n");
+    }
+
+    // test 35 FixedBigInteger: constexpr-константы, переполнение и арифметика по модулю 2^N
+    {
+        using U256 = FixedBigInteger<256>;
+        using W256 = FixedBigInteger<256, true>;
+        constexpr U256 p = 0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff_fbi;
+        constexpr U256 q = p - 12345 * U256(1000000007);
+        static_assert(q < p && p - q == U256(12345000086415));
+        static_assert(W256(0) - W256(1) == W256(-1) && (W256(-1) + W256(1)) == W256(0));
+        static_assert(p.mulFull(p).limbs()[7] == 0xfffffffe00000002);
+        // 1.5_fbi, 1e3_fbi, 0x1p3_fbi, 0b102_fbi и 09_fbi не компилируются: не цифры своей системы
+        static_assert(FbiDigits<'1', '\'', '0'> && FbiDigits<'0', 'x', 'f', 'F'> && FbiDigits<'0', '7'>);
+        static_assert(!FbiDigits<'1', '.', '5'> && !FbiDigits<'1', 'e', '3'> && !FbiDigits<'0', 'x', '1', 'p', '3'>
+                      && !FbiDigits<'0', 'b', '1', '0', '2'> && !FbiDigits<'0', '9'>);
+        static_assert(1'000_fbi == FixedBigInteger<128>(1000));
+
+        mpz_class a, b, mod;
+        mpz_ui_pow_ui(a.get_mpz_t(), 3, 100);
+        mpz_ui_pow_ui(b.get_mpz_t(), 7, 30);
+        mpz_ui_pow_ui(mod.get_mpz_t(), 2, 256);
+        mpz_class sum = a + b, diff = a - b, prod = a * b, wprod = a * a % mod, wdiff = (b - a) % mod + mod, full = a * a;
+
+        U256 fa((3_bi).pow(100)), fb((7_bi).pow(30));
+        W256 wa = fa, wb = fb;
+        bool overflowed = false;
+        try {
+            fa * fa;
+        } catch (const std::overflow_error&) {
+            overflowed = true;
+        }
+        bool ok = equal(sum, (fa + fb).toBigInteger()) && equal(diff, (fa - fb).toBigInteger())
+               && equal(prod, (fa * fb).toBigInteger()) && equal(wprod, (wa * wa).toBigInteger())
+               && equal(wdiff, (wb - wa).toBigInteger()) && equal(full, fa.mulFull(fa).toBigInteger())
+               && equal(a, BigInteger(BigIntegerView(fa))) && overflowed && fb < fa
+               && W256(0_bi - 1_bi) == W256(-1);
+        std::cout << (ok ? "Test 35 passed\n" : "Test 35 failed\n");
+    }
+
+    // test 36 простота: BPSW против mpz_probab_prime_p, Люка-Лемер против известных простых Мерсенна
+    {
+        bool ok = true;
+        for (long v = 0; ok && v < 20000; ++v)
+            ok = BigInteger(v).isProbablePrime() == (mpz_probab_prime_p(mpz_class(v).get_mpz_t(), 30) > 0);
+
+        mpz_class start, p, q;
+        mpz_ui_pow_ui(start.get_mpz_t(), 3, 200);
+        for (int i = 0; ok && i < 20; ++i) {
+            mpz_nextprime(p.get_mpz_t(), start.get_mpz_t());
+            mpz_nextprime(q.get_mpz_t(), p.get_mpz_t());
+            BigInteger bi_p(p.get_str()), bi_q(q.get_str());
+            ok = bi_p.isProbablePrime(2) && !BigInteger(bi_p * bi_q).isProbablePrime()
+                 && !BigInteger(bi_p * bi_p).isProbablePrime();
+            start = q * 7;
+        }
+        // сильные псевдопростые по основаниям 2, 3, 5, 7 и сильные псевдопростые Люка
+        for (const char* s : {"3215031751", "3825123056546413051", "318665857834031151167461", "5459", "5777", "10877"})
+            ok = ok && !BigInteger(s).isProbablePrime();
+        ok = ok && ((1_bi << 521) - 1_bi).isProbablePrime() && !((1_bi << 523) - 1_bi).isProbablePrime()
+                && !BigInteger(-7).isProbablePrime();
+
+        const std::vector<unsigned long long> mersenne = {2, 3, 5, 7, 13, 17, 19, 31, 61, 89, 107, 127, 521, 607, 1279};
+        for (unsigned long long e = 1; ok && e <= 1300; ++e)
+            ok = BigInteger::lucasLehmer(e) == (std::find(mersenne.begin(), mersenne.end(), e) != mersenne.end());
+        std::cout << (ok ? "Test 36 passed\n" : "Test 36 failed\n");
+    }
+
+    // test 37 корни: sqrtRem, nthRoot и isPerfectPower против mpz_sqrtrem, mpz_root и mpz_perfect_power_p
+    {
+        mpz_class a, s, r, root;
+        mpz_ui_pow_ui(a.get_mpz_t(), 12345, 20000);
+        a += 987654321;
+        BigInteger bi_a = (12345_bi).pow(20000) + 987654321_bi;
+        mpz_sqrtrem(s.get_mpz_t(), r.get_mpz_t(), a.get_mpz_t());
+        auto [bi_s, bi_r] = bi_a.sqrtRem();
+        bool ok = equal(s, bi_s) && equal(r, bi_r) && equal(s, bi_a.isqrt());
+
+        for (unsigned long long k : {3ull, 7ull, 64ull, 1001ull, 300000ull}) {
+            mpz_root(root.get_mpz_t(), a.get_mpz_t(), k);
+            ok = ok && equal(root, bi_a.nthRoot(k));
+        }
+        mpz_class neg = -a;
+        mpz_root(root.get_mpz_t(), neg.get_mpz_t(), 5);
+        ok = ok && equal(root, (0_bi - bi_a).nthRoot(5));
+
+        BigInteger base = (1234567_bi).pow(500) + 1_bi, power = base.pow(3), square = base.pow(2);
+        ok = ok && power.isPerfectPower() && (0_bi - power).isPerfectPower() && !(power + 1_bi).isPerfectPower()
+                && square.isPerfectPower() && !(0_bi - square).isPerfectPower() && !bi_a.isPerfectPower()
+                && (1_bi << 1000).isPerfectPower() && !(0_bi - (1_bi << 1024)).isPerfectPower()
+                && (0_bi).isPerfectPower() && (1_bi).isPerfectPower();
+        for (long v = -2000; ok && v <= 2000; ++v)
+            ok = BigInteger(v).isPerfectPower() == (mpz_perfect_power_p(mpz_class(v).get_mpz_t()) != 0);
+        std::cout << (ok ? "Test 37 passed\n" : "Test 37 failed\n");
+    }
+
     // test 14 2^136279841 -1
     {
         